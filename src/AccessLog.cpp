@@ -0,0 +1,381 @@
+/**
+ * @file  AccessLog.cpp
+ * @brief AccessLog
+ *
+ * Class implementation for AccessLog
+ *
+ * The AccessLog records one line for every response in the Common or Combined
+ * Log Format (with the time taken to answer the request, in microseconds,
+ * appended to each line) or as a JSON object per line.  One in every N lines
+ * can also be given the time taken by each stage of answering the request (see
+ * Trace)
+ *
+ * Serving threads only copy the details of each request into a ring of their
+ * own (see ThreadRings); a background writer thread formats them into a large
+ * batch that is written once it fills, or once its oldest line is a tenth of a
+ * second old, so that logging never costs a client a system call.  Records are
+ * dropped (and the number dropped is reported as a debug message) instead of
+ * making the serving threads wait if the writer falls behind
+ *
+ * The log is reopened by the writer after the process receives SIGHUP so that
+ * it can be rotated; the file must be writable by the account the server runs
+ * as at that point
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include "include/AccessLog.hpp"
+#include "include/Metrics.hpp"
+#include "include/Trace.hpp"
+#include "include/View.hpp"
+#include "include/slwhttp.hpp"
+
+// Initialize static members
+std::atomic<int>              AccessLog::fd{-1};
+AccessLog::Format             AccessLog::format{AccessLog::Format::Common};
+std::atomic<size_t>           AccessLog::lost{0};
+std::string                   AccessLog::path{};
+std::atomic<bool>             AccessLog::reopening{false};
+ThreadRings<AccessLog::Record, ACCESSRECORDS> AccessLog::rings{};
+std::atomic<bool>             AccessLog::running{false};
+std::thread                   AccessLog::writer{};
+
+// The amount of time a formatted line may wait to be written
+static const std::chrono::milliseconds linger{100};
+
+// The names of the stages that a sampled line lists the time taken by
+static const char* const stages[Metrics::Total] = {
+  "header_read_us", "resolve_us", "first_byte_us"
+};
+
+/**
+ * @brief Escape
+ *
+ * Appends text to a line, escaping quotes, backslashes and control characters
+ * as `\xHH` (or, for JSON, as `\"`, `\\` and `\u00HH`)
+ *
+ * @param  out   The line
+ * @param  text  The text
+ * @param  json  Whether or not the text is a JSON string
+ */
+static void escape(std::string& out, View text, bool json) {
+  static const char digits[] = "0123456789abcdef";
+  for (size_t i = 0; i < text.length; ++i) {
+    unsigned char c = static_cast<unsigned char>(text.data[i]);
+    if (c >= 0x20 && c != 0x7f && c != '"' && c != '\\' && (json || c < 0x80))
+      out += static_cast<char>(c);
+    else if (json && (c == '"' || c == '\\')) {
+      out += '\\';
+      out += static_cast<char>(c);
+    }
+    else {
+      out += (json ? "\\u00" : "\\x");
+      out += digits[c >> 4];
+      out += digits[c & 0xf];
+    }
+  }
+}
+
+/**
+ * @brief Append
+ *
+ * Formats a record as a line at the end of a batch
+ *
+ * @param  out     The batch
+ * @param  record  The record
+ */
+void AccessLog::append(std::string& out, const Record& record) {
+  View fields[Record::Fields];
+  for (size_t i = 0, offset = 0; i < Record::Fields; ++i) {
+    fields[i] = View{record.text + offset, record.lengths[i]};
+    offset   += record.lengths[i];
+  }
+  char address[INET6_ADDRSTRLEN] = "-";
+  if (record.family == AF_INET || record.family == AF_INET6)
+    inet_ntop(record.family, record.address, address, sizeof(address));
+  time_t    seconds = static_cast<time_t>(record.time / 1000000);
+  struct tm parts{};
+  char      stamp[48] = {};
+  char      number[64] = {};
+  if (AccessLog::format == Format::JSON) {
+    gmtime_r(&seconds, &parts);
+    size_t length = strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S",
+      &parts);
+    snprintf(stamp + length, sizeof(stamp) - length, ".%06lldZ",
+      static_cast<long long>(record.time % 1000000));
+    out += "{\"time\":\"";
+    out += stamp;
+    out += "\",\"address\":\"";
+    out += address;
+    const char* names[Record::Fields] = {
+      "method", "path", "version", "referer", "user_agent"
+    };
+    for (size_t i = 0; i < Record::Fields; ++i) {
+      out += "\",\"";
+      out += names[i];
+      out += "\":\"";
+      escape(out, fields[i], true);
+    }
+    snprintf(number, sizeof(number), "\",\"status\":%d,\"bytes\":",
+      record.status);
+    out += number;
+    if (record.bytes < 0)
+      out += "null";
+    else
+      out += std::to_string(record.bytes);
+    out += ",\"duration_us\":";
+    out += std::to_string(record.duration);
+    if (record.traced == true) {
+      out += ",\"trace\":{";
+      for (size_t i = 0; i < Metrics::Total; ++i) {
+        out += (i == 0 ? "\"" : ",\"");
+        out += stages[i];
+        out += "\":";
+        out += (record.spans[i] < 0 ? "null" :
+          std::to_string(record.spans[i]));
+      }
+      out += '}';
+    }
+    out += "}\n";
+    return;
+  }
+  localtime_r(&seconds, &parts);
+  strftime(stamp, sizeof(stamp), "%d/%b/%Y:%H:%M:%S %z", &parts);
+  out += address;
+  out += " - - [";
+  out += stamp;
+  out += "] \"";
+  escape(out, fields[Record::Method], false);
+  out += ' ';
+  escape(out, fields[Record::Target], false);
+  if (fields[Record::Version].empty() == false)
+    out += ' ';
+  escape(out, fields[Record::Version], false);
+  snprintf(number, sizeof(number), "\" %d ", record.status);
+  out += number;
+  if (record.bytes <= 0)
+    out += '-';
+  else
+    out += std::to_string(record.bytes);
+  if (AccessLog::format == Format::Combined)
+    for (size_t i = Record::Referer; i <= Record::UserAgent; ++i) {
+      out += " \"";
+      if (fields[i].empty())
+        out += '-';
+      else
+        escape(out, fields[i], false);
+      out += '"';
+    }
+  out += ' ';
+  out += std::to_string(record.duration);
+  for (size_t i = 0; record.traced && i < Metrics::Total; ++i) {
+    out += ' ';
+    out += stages[i];
+    out += '=';
+    out += (record.spans[i] < 0 ? "-" : std::to_string(record.spans[i]));
+  }
+  out += '\n';
+}
+
+/**
+ * @brief Enabled
+ *
+ * Determines if an access log was opened
+ *
+ * @return  true if requests should be logged, otherwise false
+ */
+bool AccessLog::enabled() {
+  return AccessLog::fd.load(std::memory_order_relaxed) >= 0;
+}
+
+/**
+ * @brief Flush
+ *
+ * Writes a batch of lines to the log and empties it
+ *
+ * @param  batch  The batch
+ */
+void AccessLog::flush(std::string& batch) {
+  const char* data   = batch.data();
+  size_t      length = batch.length();
+  while (length > 0) {
+    ssize_t written = write(AccessLog::fd.load(), data, length);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0) {
+      debug_error("failed to write the access log");
+      break;
+    }
+    data   += written;
+    length -= static_cast<size_t>(written);
+  }
+  batch.clear();
+}
+
+/**
+ * @brief Log
+ *
+ * Queues a record of a response for the background writer
+ *
+ * @param  peer      The address of the client
+ * @param  request   The completed request
+ * @param  response  The response to the request
+ * @param  trace     The stages the request passed through
+ * @param  start     When the request was received
+ * @param  complete  Whether or not the entire response was sent
+ */
+void AccessLog::log(const struct sockaddr_storage& peer,
+    const Request& request, const Response& response, const Trace& trace,
+    std::chrono::steady_clock::time_point start, bool complete) {
+  if (AccessLog::enabled() == false)
+    return;
+  int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+  int64_t now      = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  bool traced = Trace::sample();
+  bool queued = AccessLog::rings.push([&](Record& record) {
+    record.time     = now - duration;
+    record.duration = duration;
+    record.bytes    = (complete ? response.bytes() : -1);
+    record.status   = response.status;
+    record.family   = static_cast<uint8_t>(peer.ss_family);
+    record.traced   = traced;
+    for (size_t i = 0; traced && i < Metrics::Total; ++i)
+      record.spans[i] = trace.span(static_cast<Metrics::Stage>(i));
+    if (peer.ss_family == AF_INET)
+      memcpy(record.address, &reinterpret_cast<const struct sockaddr_in&>(
+        peer).sin_addr, sizeof(struct in_addr));
+    else if (peer.ss_family == AF_INET6)
+      memcpy(record.address, &reinterpret_cast<const struct sockaddr_in6&>(
+        peer).sin6_addr, sizeof(struct in6_addr));
+    const View fields[Record::Fields] = {
+      request.getMethod(), request.getTarget(), request.getVersion(),
+      request.header("referer"), request.header("user-agent")
+    };
+    // Truncate the text to fit, giving the earlier fields priority
+    size_t used = 0;
+    for (size_t i = 0; i < Record::Fields; ++i) {
+      size_t length = std::min(fields[i].length, sizeof(record.text) - used);
+      memcpy(record.text + used, fields[i].data, length);
+      record.lengths[i] = static_cast<uint16_t>(length);
+      used += length;
+    }
+  });
+  if (queued == false)
+    AccessLog::lost.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Open
+ *
+ * Opens (or creates) the access log for appending
+ *
+ * @param  path    The path of the log
+ * @param  format  The format of each line
+ */
+void AccessLog::open(const std::string& path, Format format) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+    0640);
+  if (fd < 0)
+    throw std::runtime_error{"could not open access log: " + path};
+  AccessLog::path   = path;
+  AccessLog::format = format;
+  AccessLog::fd.store(fd);
+}
+
+/**
+ * @brief Reopen
+ *
+ * Asks the background writer to reopen the log (once SIGHUP is received, so
+ * that it can be rotated)
+ */
+void AccessLog::reopen() {
+  AccessLog::reopening.store(true);
+}
+
+/**
+ * @brief Run
+ *
+ * Formats queued records into batches until the log is stopped, writing each
+ * batch once it fills or lingers for too long
+ */
+void AccessLog::run() {
+  typedef std::chrono::steady_clock clock;
+  std::string batch{};
+  batch.reserve(ACCESSBATCH + ACCESSTEXT * 2);
+  clock::time_point oldest{};
+  bool running = true;
+  while (running) {
+    running = AccessLog::running.load();
+    bool waiting = AccessLog::rings.drain([&](const Record& record) {
+      if (batch.empty())
+        oldest = clock::now();
+      AccessLog::append(batch, record);
+      if (batch.length() >= ACCESSBATCH)
+        AccessLog::flush(batch);
+    }, [](size_t dropped) {
+      AccessLog::lost.fetch_add(dropped);
+    });
+    size_t lost = AccessLog::lost.exchange(0);
+    if (lost > 0)
+      debug("dropped {} access log records", lost);
+    if (batch.empty() == false && (running == false ||
+        clock::now() - oldest >= linger))
+      AccessLog::flush(batch);
+    if (AccessLog::reopening.exchange(false)) {
+      AccessLog::flush(batch);
+      int fd = ::open(AccessLog::path.c_str(), O_WRONLY | O_CREAT | O_APPEND |
+        O_CLOEXEC, 0640);
+      if (fd < 0)
+        debug_error("could not reopen access log: {}", AccessLog::path);
+      else
+        close(AccessLog::fd.exchange(fd));
+    }
+    if (waiting == false && running == true)
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+}
+
+/**
+ * @brief Start
+ *
+ * Starts the background writer thread (which must happen after the process
+ * has daemonized, since threads don't survive `fork`)
+ */
+void AccessLog::start() {
+  bool running = false;
+  if (AccessLog::enabled() &&
+      AccessLog::running.compare_exchange_strong(running, true)) {
+    AccessLog::writer = std::thread{AccessLog::run};
+    atexit(AccessLog::stop);
+  }
+}
+
+/**
+ * @brief Stop
+ *
+ * Stops the background writer thread once every queued record is written
+ */
+void AccessLog::stop() {
+  AccessLog::running.store(false);
+  if (AccessLog::writer.joinable())
+    AccessLog::writer.join();
+}
@@ -0,0 +1,135 @@
+/**
+ * @file  Admission.cpp
+ * @brief Admission
+ *
+ * Class implementation for Admission
+ *
+ * Admission keeps count of the connected clients and of the requests being
+ * answered, so that the server sheds load predictably once either passes its
+ * configured limit instead of taking on more work than it can finish
+ *
+ * Clients beyond the connection limit are sent a pre-rendered 503 response (as
+ * far as a single non-blocking write allows) and disconnected without waiting
+ * for their request, while requests beyond the in-flight limit are answered
+ * with the same response on their own connections.  TLS clients are simply
+ * disconnected when turned away, since they can't read a plaintext response
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <atomic>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "include/Admission.hpp"
+#include "include/Metrics.hpp"
+#include "include/Tls.hpp"
+#include "include/slwhttp.hpp"
+
+// Initialize static members
+std::atomic<int> Admission::clients{0};
+int              Admission::max_clients  = 0;
+int              Admission::max_requests = 0;
+std::atomic<int> Admission::requests{0};
+
+/**
+ * @brief Admit
+ *
+ * Counts a newly accepted client, unless the connection limit has been reached
+ *
+ * @return  true if the client may be served (and must later `leave`),
+ *          otherwise false
+ */
+bool Admission::admit() {
+  int count = Admission::clients.fetch_add(1) + 1;
+  if (Admission::max_clients > 0 && count > Admission::max_clients) {
+    Admission::clients.fetch_sub(1);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Connected
+ *
+ * Fetches the number of admitted clients that haven't yet left
+ *
+ * @return  The number of connected clients
+ */
+int Admission::connected() {
+  return Admission::clients.load();
+}
+
+/**
+ * @brief Finish Request
+ *
+ * Stops counting a request that was admitted by `startRequest`
+ */
+void Admission::finishRequest() {
+  if (Admission::max_requests > 0)
+    Admission::requests.fetch_sub(1);
+}
+
+/**
+ * @brief Leave
+ *
+ * Stops counting a client that was admitted by `admit`
+ */
+void Admission::leave() {
+  Admission::clients.fetch_sub(1);
+}
+
+/**
+ * @brief Reject
+ *
+ * Turns away a client that wasn't admitted, then disconnects it
+ *
+ * @param  fd  The file descriptor of the client
+ */
+void Admission::reject(int fd) {
+  Metrics::add(Metrics::Rejects);
+  if (Tls::enabled() == false) {
+    const std::string& response = unavailable_response();
+    if (send(fd, response.data(), response.length(), MSG_DONTWAIT |
+        MSG_NOSIGNAL) > 0)
+      Metrics::served(503, 0);
+  }
+  shutdown(fd, SHUT_RDWR);
+  close(fd);
+  debug("rejected client: {}", fd);
+}
+
+/**
+ * @brief Set Limits
+ *
+ * Sets the limits beyond which clients and requests are turned away (zero
+ * disables a limit)
+ *
+ * @param  clients   The maximum number of connected clients
+ * @param  requests  The maximum number of requests being answered at once
+ */
+void Admission::setLimits(int clients, int requests) {
+  Admission::max_clients  = clients;
+  Admission::max_requests = requests;
+}
+
+/**
+ * @brief Start Request
+ *
+ * Counts a request that is about to be answered, unless the in-flight limit
+ * has been reached
+ *
+ * @return  true if the request may be answered (and must later be finished
+ *          with `finishRequest`), otherwise false
+ */
+bool Admission::startRequest() {
+  if (Admission::max_requests <= 0)
+    return true;
+  int count = Admission::requests.fetch_add(1) + 1;
+  if (count > Admission::max_requests) {
+    Admission::requests.fetch_sub(1);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file  BufferPool.cpp
+ * @brief BufferPool
+ *
+ * Class implementation for BufferPool
+ *
+ * A BufferPool hands out fixed-size receive buffers to connections and takes
+ * them back once a connection finishes or goes idle, keeping up to a fixed
+ * number of released buffers for reuse so that a storm of short connections
+ * neither grows memory use nor goes back to the allocator for every client
+ *
+ * Each Worker owns a pool of its own, so its lock is never contended
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "include/BufferPool.hpp"
+
+/**
+ * @brief BufferPool Constructor
+ *
+ * Creates an empty pool of buffers with the given size
+ *
+ * @param  size   The size of each buffer in bytes
+ * @param  limit  The maximum number of released buffers to keep for reuse
+ */
+BufferPool::BufferPool(size_t size, size_t limit): limit{limit}, size{size} {
+  this->buffers.reserve(limit);
+}
+
+/**
+ * @brief BufferPool Destructor
+ *
+ * Frees the buffers held for reuse
+ */
+BufferPool::~BufferPool() {
+  for (char* buffer : this->buffers)
+    delete[] buffer;
+}
+
+/**
+ * @brief Acquire
+ *
+ * Takes a buffer from the pool, allocating a new one if none are available
+ *
+ * @return  A buffer of getSize() bytes
+ */
+char* BufferPool::acquire() {
+  {
+    std::unique_lock<std::mutex> lock{this->mutex};
+    if (this->buffers.size() > 0) {
+      char* buffer = this->buffers.back();
+      this->buffers.pop_back();
+      return buffer;
+    }
+  }
+  return new char[this->size];
+}
+
+/**
+ * @brief Get Size
+ *
+ * Fetches the size of each buffer in the pool
+ *
+ * @return  The size of each buffer in bytes
+ */
+size_t BufferPool::getSize() const {
+  return this->size;
+}
+
+/**
+ * @brief Release
+ *
+ * Returns a buffer to the pool, freeing it if the pool is already full
+ *
+ * @param  buffer  A buffer that was returned by acquire()
+ */
+void BufferPool::release(char* buffer) {
+  if (buffer == nullptr)
+    return;
+  {
+    std::unique_lock<std::mutex> lock{this->mutex};
+    if (this->buffers.size() < this->limit) {
+      this->buffers.push_back(buffer);
+      return;
+    }
+  }
+  delete[] buffer;
+}
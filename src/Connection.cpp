@@ -0,0 +1,661 @@
+/**
+ * @file  Connection.cpp
+ * @brief Connection
+ *
+ * Class implementation for Connection
+ *
+ * A Connection is a state machine that services a single non-blocking client
+ * on behalf of a Worker: it collects the request headers, then transmits the
+ * queued response a chunk at a time as the socket becomes writable, and then
+ * returns to reading the next request if the client asked to keep alive
+ *
+ * Everything a request needs is held by the connection and reused for the
+ * next one (the pooled receive buffer, the response and the request path), so
+ * answering a request on an established connection doesn't allocate memory
+ *
+ * The same state machine can instead be driven by io_uring completions (see
+ * `submit` and `complete`), in which case each request is received directly
+ * into the request's buffer, the response header is sent with a single
+ * `sendmsg` and the file is moved to the client through a pipe held by the
+ * connection, using a `splice` from the file into the pipe that is linked to a
+ * `splice` from the pipe into the socket
+ *
+ * Each connection is counted by Admission from the moment its worker admits it,
+ * and each of its requests from the end of the request headers until the
+ * response has been sent (a request beyond the in-flight limit is answered
+ * with a 503 response and the connection closed)
+ *
+ * When TLS is enabled, each connection begins by completing its handshake
+ * (see Tls), after which the same state machine runs over the session
+ *
+ * Files are sent at most SENDCHUNK bytes per turn before the worker moves on to
+ * its other clients, so a large download can't hold up the small responses
+ * sharing its worker.  Each chunk must also be granted by the connection's
+ * Throttle; while it waits for the bandwidth limits, the connection stops
+ * watching its socket (or waits on an io_uring timeout) until `paused` passes
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "include/AccessLog.hpp"
+#include "include/Admission.hpp"
+#include "include/Connection.hpp"
+#include "include/Request.hpp"
+#include "include/FileCache.hpp"
+#include "include/Metrics.hpp"
+#include "include/Tls.hpp"
+#include "include/slwhttp.hpp"
+
+// The amount of time a client may stall (once its request headers have
+// arrived) before it is disconnected
+static const std::chrono::seconds timeout{3};
+
+/**
+ * @brief Connection Constructor
+ *
+ * Takes ownership of a non-blocking client file descriptor
+ *
+ * @param  fd    The file descriptor of the associated client
+ * @param  pool  The pool from which receive buffers are borrowed
+ * @param  peer  The address of the client
+ */
+Connection::Connection(int fd, BufferPool& pool,
+    const struct sockaddr_storage& peer): fd{fd}, peer(peer), request{pool},
+    trace{fd} {
+  // The handshake and the first request headers must arrive in time
+  this->deadline = std::chrono::steady_clock::now() +
+    std::chrono::seconds{_header_timeout};
+  if (Tls::enabled()) {
+    this->ssl   = Tls::accept(fd);
+    this->state = (this->ssl != nullptr ? State::Handshaking : State::Closing);
+  }
+}
+
+/**
+ * @brief Connection Destructor
+ *
+ * Disconnects the associated client (logging any response that was cut short)
+ */
+Connection::~Connection() {
+  if (this->response.status != 0) {
+    AccessLog::log(this->peer, this->request, this->response, this->trace,
+      this->start, false);
+    Metrics::served(this->response.status, 0);
+  }
+  if (this->in_flight == true)
+    Admission::finishRequest();
+  Admission::leave();
+  Tls::release(this->ssl);
+  // Close the file descriptors
+  for (int end : this->pipefd)
+    if (end >= 0)
+      close(end);
+  shutdown(this->fd, SHUT_RDWR);
+  close(this->fd);
+  debug("disconnect fd: {}", this->fd);
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Complete
+ *
+ * Advances the state machine in response to the completion of one of the
+ * connection's io_uring operations, submitting the next operation
+ *
+ * @param  ring       The ring to which the operation was submitted
+ * @param  operation  The kind of operation
+ * @param  result     The result of the operation (a negated errno on failure)
+ *
+ * @return            true if the connection should be kept, otherwise false
+ *                    (in which case it must only be destroyed once
+ *                    `pending` is zero)
+ */
+bool Connection::complete(IoRing& ring, Operation operation, int result) {
+  --this->operations;
+  if (this->state == State::Closing)
+    return false;
+  switch (operation) {
+    case Receive:
+      // The client has disconnected if no data was received from it
+      if (result <= 0)
+        return this->disconnect();
+      if (this->first == std::chrono::steady_clock::time_point{})
+        this->first = std::chrono::steady_clock::now();
+      this->request.received(static_cast<size_t>(result));
+      if (this->request.overflow())
+        return this->disconnect();
+      return this->submit(ring);
+    case Send:
+      if (result == -EAGAIN || result == -EINTR)
+        return this->submit(ring);
+      if (result < 0)
+        return this->disconnect();
+      if (this->response.sent == 0)
+        this->trace.mark(Metrics::FirstByte,
+          std::chrono::steady_clock::now() - this->start);
+      this->response.sent += static_cast<size_t>(result);
+      this->deadline = std::chrono::steady_clock::now() + timeout;
+      return this->submit(ring);
+    case SpliceIn:
+      // The file was truncated (or couldn't be read) while it was being sent
+      if (result <= 0)
+        this->failed = true;
+      else {
+        this->piped           += static_cast<size_t>(result);
+        this->response.offset += result;
+        this->response.length -= result;
+      }
+      break;
+    case Resume:
+      this->resume = std::chrono::steady_clock::time_point{};
+      break;
+    case SpliceOut:
+      // The pipe is only drained in the same step if it was completely filled
+      if (result > 0) {
+        this->piped   -= static_cast<size_t>(result);
+        this->deadline = std::chrono::steady_clock::now() + timeout;
+      }
+      else if (result != -ECANCELED)
+        this->failed = true;
+      break;
+    default:
+      return this->disconnect();
+  }
+  // Wait for both halves of a splice to complete
+  if (this->operations > 0)
+    return true;
+  if (this->failed == true) {
+    Metrics::add(Metrics::SendfileErrors);
+    return this->disconnect();
+  }
+  if (this->piped > 0)
+    return this->splice(ring, this->piped, false);
+  return this->submit(ring);
+}
+#endif
+
+/**
+ * @brief Disconnect
+ *
+ * Shuts down the client's socket so that any operations still in flight
+ * complete promptly, leaving the connection to be destroyed
+ *
+ * @return  false, since the connection should no longer be kept
+ */
+bool Connection::disconnect() {
+  shutdown(this->fd, SHUT_RDWR);
+  this->state = State::Closing;
+  return false;
+}
+
+/**
+ * @brief Expired
+ *
+ * Determines if the client has stalled for longer than it is allowed to
+ *
+ * @param  now  The current time
+ *
+ * @return      true if the connection should be dropped, otherwise false
+ */
+bool Connection::expired(std::chrono::steady_clock::time_point now) const {
+  return now >= this->deadline;
+}
+
+/**
+ * @brief Finish Response
+ *
+ * Records the response that was just sent and releases its file
+ */
+void Connection::finishResponse() {
+  Metrics::served(this->response.status, this->response.bytes());
+  this->trace.mark(Metrics::Total, std::chrono::steady_clock::now() -
+    this->start);
+  AccessLog::log(this->peer, this->request, this->response, this->trace,
+    this->start, true);
+  this->throttle.finish();
+  if (this->in_flight == true)
+    Admission::finishRequest();
+  this->in_flight = false;
+  this->response  = Response{};
+  this->trace.reset();
+}
+
+/**
+ * @brief Handle
+ *
+ * Advances the state machine in response to the given epoll events
+ *
+ * @param  events  The events reported by epoll for the client
+ *
+ * @return         true if the connection should be kept, otherwise false
+ */
+bool Connection::handle(uint32_t events) {
+  if (events & EPOLLERR)
+    return false;
+  // A client that hangs up while waiting for the throttle can't be sent to
+  if ((events & EPOLLHUP) && this->resume !=
+      std::chrono::steady_clock::time_point{})
+    return false;
+  if (this->state == State::Handshaking &&
+      (events & (EPOLLIN | EPOLLOUT | EPOLLHUP)))
+    return this->handshake();
+  if (this->state == State::Reading && (events & (EPOLLIN | EPOLLHUP)))
+    return this->readRequest();
+  if (this->state == State::Writing && (events & EPOLLOUT))
+    return this->writeResponses();
+  return this->state != State::Closing;
+}
+
+/**
+ * @brief Events
+ *
+ * Determines which epoll events the connection is currently waiting on
+ *
+ * @return  EPOLLIN while reading the request (or while the handshake waits to
+ *          receive), nothing while waiting for the throttle, otherwise EPOLLOUT
+ */
+uint32_t Connection::events() const {
+  if (this->resume != std::chrono::steady_clock::time_point{})
+    return 0;
+  if (this->state == State::Handshaking)
+    return (this->want_write == true ? EPOLLOUT : EPOLLIN);
+  return (this->state == State::Reading ? EPOLLIN : EPOLLOUT);
+}
+
+/**
+ * @brief Handshake
+ *
+ * Advances the TLS handshake as far as the client's socket allows, then starts
+ * reading the first request
+ *
+ * @return  true if the connection should be kept, otherwise false
+ */
+bool Connection::handshake() {
+  switch (Tls::handshake(this->ssl)) {
+    case Tls::Result::Done:
+      this->state      = State::Reading;
+      this->want_write = false;
+      // The request may have arrived along with the end of the handshake
+      return this->readRequest();
+    case Tls::Result::WantRead:
+      this->want_write = false;
+      return true;
+    case Tls::Result::WantWrite:
+      this->want_write = true;
+      return true;
+    default:
+      this->state = State::Closing;
+      return false;
+  }
+}
+
+/**
+ * @brief Hold
+ *
+ * Holds back the rest of the file until the throttle allows more of it to be
+ * sent, without counting the wait against the client
+ */
+void Connection::hold() {
+  this->resume   = this->throttle.resume();
+  this->deadline = this->resume + timeout;
+}
+
+/**
+ * @brief Idle
+ *
+ * Determines if the connection is waiting for a request that hasn't started to
+ * arrive (so that it can be closed without interrupting anything)
+ *
+ * @return  true if no part of the next request has been received, otherwise
+ *          false
+ */
+bool Connection::idle() const {
+  return this->state == State::Reading && this->request.complete() == false &&
+    this->first == std::chrono::steady_clock::time_point{};
+}
+
+/**
+ * @brief Paused
+ *
+ * Determines when a connection waiting for the throttle may send again
+ *
+ * @return  The time at which to resume sending, or the epoch if the connection
+ *          isn't waiting
+ */
+std::chrono::steady_clock::time_point Connection::paused() const {
+  return this->resume;
+}
+
+/**
+ * @brief Pending
+ *
+ * Determines how many of the connection's io_uring operations are in flight
+ *
+ * @return  The number of operations that haven't completed
+ */
+size_t Connection::pending() const {
+  return this->operations;
+}
+
+/**
+ * @brief Queue Response
+ *
+ * Resolves the completed request to a response in the same manner as
+ * process_request(...) and prepares it for transmission
+ *
+ * @return  true if a response was prepared, otherwise false
+ */
+bool Connection::queueResponse() {
+  this->start = std::chrono::steady_clock::now();
+  // Requests that were received along with the previous one took no time to
+  // read
+  this->trace.mark(Metrics::HeaderRead, (this->first ==
+    std::chrono::steady_clock::time_point{} ?
+    std::chrono::steady_clock::duration{0} : this->start - this->first));
+  this->first = std::chrono::steady_clock::time_point{};
+  if (_debug == true) {
+    debug("request content (from fd: {}):", this->fd);
+    View lines[MAXFIELDS + 1];
+    size_t count = this->request.lines(lines, MAXFIELDS + 1);
+    for (size_t i = 0; i < count; ++i)
+      debug("    {}", lines[i]);
+  }
+  // Stop keeping connections alive once the listening sockets have been handed
+  // to a new process, so that clients reconnect to it
+  this->keep_alive = (_keepalive > 0 && this->request.keepAlive() &&
+    _draining.load() == false);
+  // Check for GET request and determine absolute request path
+  if (request_path(this->request, this->path) == false)
+    return false;
+  // Turn the request away if too many are already being answered
+  this->in_flight = Admission::startRequest();
+  if (this->in_flight == false) {
+    this->keep_alive = false;
+    this->response   = Response::unavailable();
+  }
+  else {
+    try {
+      debug("raw request for path: {}", this->path);
+      // Attempt to open the file for the client
+      std::shared_ptr<const FileCache::Entry> file = FileCache::open(
+        this->path);
+      this->trace.mark(Metrics::Resolve, std::chrono::steady_clock::now() -
+        this->start);
+      this->response = Response::serve(file, this->request, this->keep_alive);
+    } catch (const std::exception& e) {
+      this->trace.mark(Metrics::Resolve, std::chrono::steady_clock::now() -
+        this->start);
+      this->response = Response::denied(this->keep_alive);
+      debug("{}", e.what());
+    }
+  }
+  this->state    = State::Writing;
+  this->deadline = std::chrono::steady_clock::now() + timeout;
+  return true;
+}
+
+/**
+ * @brief Read Request
+ *
+ * Reads as much of the request headers as is available from the client and
+ * prepares the response once an empty line is found
+ *
+ * @return  true if the connection should be kept, otherwise false
+ */
+bool Connection::readRequest() {
+  // Loop until the socket has no more data to offer
+  while (this->request.complete() == false) {
+    // Read the incoming data directly into the request's buffer
+    size_t length = 0;
+    char*  buffer = this->request.space(length);
+    ssize_t data_read = Tls::read(this->ssl, this->fd, buffer, length);
+    if (data_read > 0) {
+      if (this->first == std::chrono::steady_clock::time_point{})
+        this->first = std::chrono::steady_clock::now();
+      this->request.received(static_cast<size_t>(data_read));
+      if (this->request.overflow())
+        return false;
+    }
+    else if (data_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return true;
+    else if (data_read < 0 && errno == EINTR)
+      continue;
+    else
+      // The client has disconnected if marked as readable, but no data was
+      // received from it
+      return false;
+  }
+  // Respond as soon as the end of the request headers arrives
+  return this->queueResponse() && this->writeResponses();
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Splice
+ *
+ * Submits the transfer of part of the response's file to the client through
+ * the connection's pipe
+ *
+ * @param  ring    The ring to submit to
+ * @param  length  The number of bytes to transfer
+ * @param  read    Whether the bytes must first be read from the file into the
+ *                 pipe, or are already waiting in the pipe
+ *
+ * @return         true if the connection should be kept, otherwise false
+ */
+bool Connection::splice(IoRing& ring, size_t length, bool read) {
+  if (this->pipefd[0] < 0) {
+    if (pipe2(this->pipefd, O_CLOEXEC) != 0) {
+      debug_error("failed to create pipe for fd: {}", this->fd);
+      return this->disconnect();
+    }
+    int size = fcntl(this->pipefd[0], F_GETPIPE_SZ);
+    this->pipe_size = (size > 0 ? static_cast<size_t>(size) : RINGSPLICE);
+  }
+  struct io_uring_sqe* sqe = nullptr;
+  if (read == true) {
+    // Never read more than the pipe can hold, so that the read can't block
+    length = std::min(length, std::min<size_t>(this->pipe_size, RINGSPLICE));
+    length = this->throttle.grant(length);
+    if (length == 0) {
+      // Try again once the throttle allows more of the file to be sent
+      this->hold();
+      auto delay = std::max(std::chrono::steady_clock::duration{0},
+        this->resume - std::chrono::steady_clock::now());
+      auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        delay).count();
+      this->delay.tv_sec  = nanoseconds / 1000000000;
+      this->delay.tv_nsec = nanoseconds % 1000000000;
+      sqe = ring.next();
+      sqe->opcode    = IORING_OP_TIMEOUT;
+      sqe->addr      = reinterpret_cast<uint64_t>(&this->delay);
+      sqe->len       = 1;
+      sqe->user_data = RINGTAG(this->fd, Resume);
+      ++this->operations;
+      return true;
+    }
+    sqe = ring.next();
+    sqe->opcode        = IORING_OP_SPLICE;
+    sqe->fd            = this->pipefd[1];
+    sqe->off           = static_cast<uint64_t>(-1);
+    sqe->splice_fd_in  = this->response.file->fd;
+    sqe->splice_off_in = static_cast<uint64_t>(this->response.offset);
+    sqe->len           = static_cast<uint32_t>(length);
+    sqe->splice_flags  = SPLICE_F_MOVE;
+    // The second half is cancelled if the first moves less than requested
+    sqe->flags         = IOSQE_IO_LINK;
+    sqe->user_data     = RINGTAG(this->fd, SpliceIn);
+    ++this->operations;
+  }
+  sqe = ring.next();
+  sqe->opcode        = IORING_OP_SPLICE;
+  sqe->fd            = this->fd;
+  sqe->off           = static_cast<uint64_t>(-1);
+  sqe->splice_fd_in  = this->pipefd[0];
+  sqe->splice_off_in = static_cast<uint64_t>(-1);
+  sqe->len           = static_cast<uint32_t>(length);
+  sqe->splice_flags  = SPLICE_F_MOVE;
+  sqe->user_data     = RINGTAG(this->fd, SpliceOut);
+  ++this->operations;
+  return true;
+}
+#endif
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Submit
+ *
+ * Submits the next io_uring operation required by the connection's state,
+ * answering any requests that were already received along the way
+ *
+ * @param  ring  The ring to submit to
+ *
+ * @return       true if the connection should be kept, otherwise false
+ */
+bool Connection::submit(IoRing& ring) {
+  while (this->state != State::Closing) {
+    if (this->state == State::Reading) {
+      // Receive more of the request directly into the request's buffer
+      if (this->request.complete() == false) {
+        size_t length = 0;
+        char*  buffer = this->request.space(length);
+        struct io_uring_sqe* sqe = ring.next();
+        sqe->opcode    = IORING_OP_RECV;
+        sqe->fd        = this->fd;
+        sqe->addr      = reinterpret_cast<uint64_t>(buffer);
+        sqe->len       = static_cast<uint32_t>(length);
+        sqe->user_data = RINGTAG(this->fd, Receive);
+        ++this->operations;
+        return true;
+      }
+      if (this->queueResponse() == false)
+        return this->disconnect();
+    }
+    Response& response = this->response;
+    if (response.status != 0) {
+      // Send the remainder of the response header (and any body held in
+      // memory), then the remainder of the requested region of the file
+      int count = response.buffers(this->iov);
+      if (count > 0) {
+        this->message            = msghdr{};
+        this->message.msg_iov    = this->iov;
+        this->message.msg_iovlen = static_cast<size_t>(count);
+        struct io_uring_sqe* sqe = ring.next();
+        sqe->opcode    = IORING_OP_SENDMSG;
+        sqe->fd        = this->fd;
+        sqe->addr      = reinterpret_cast<uint64_t>(&this->message);
+        sqe->len       = 1;
+        sqe->msg_flags = MSG_NOSIGNAL | (response.more() ? MSG_MORE : 0);
+        sqe->user_data = RINGTAG(this->fd, Send);
+        ++this->operations;
+        return true;
+      }
+      if (response.more())
+        return this->splice(ring, static_cast<size_t>(response.length), true);
+      this->finishResponse();
+    }
+    // The response has been sent, so the client can be disconnected unless
+    // it asked to keep the connection alive
+    if (this->keep_alive == false)
+      return this->disconnect();
+    this->request.consume();
+    this->state    = State::Reading;
+    this->deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds{_keepalive};
+  }
+  return false;
+}
+#endif
+
+/**
+ * @brief Write Responses
+ *
+ * Writes as much of the pending response as the client's socket will accept
+ * without blocking
+ *
+ * @return  true if the connection should be kept, otherwise false
+ */
+bool Connection::writeResponses() {
+  this->resume = std::chrono::steady_clock::time_point{};
+  while (true) {
+    if (this->response.status != 0) {
+      Response& response = this->response;
+      // Send the remainder of the response header (and any body held in
+      // memory), coalescing it with the start of the file that follows it
+      struct iovec iov[RESPONSEBUFS];
+      int count = response.buffers(iov);
+      while (count > 0) {
+        ssize_t return_val = Tls::send(this->ssl, this->fd, iov, count,
+          response.more());
+        if (return_val < 0)
+          return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        if (response.sent == 0)
+          this->trace.mark(Metrics::FirstByte,
+            std::chrono::steady_clock::now() - this->start);
+        response.sent += static_cast<size_t>(return_val);
+        count = response.buffers(iov);
+        this->deadline = std::chrono::steady_clock::now() + timeout;
+      }
+      // Send the remainder of the requested region of the file, giving the
+      // worker's other clients a turn after each chunk
+      size_t budget = SENDCHUNK;
+      while (response.more()) {
+        if (budget == 0)
+          return true;
+        size_t chunk = this->throttle.grant(static_cast<size_t>(
+          std::min<int64_t>(response.length, static_cast<int64_t>(budget))));
+        if (chunk == 0) {
+          this->hold();
+          return true;
+        }
+        int64_t offset = response.offset;
+        ssize_t return_val = Tls::sendfile(this->ssl, this->fd,
+          response.file->fd, &response.offset, static_cast<int64_t>(chunk));
+        size_t sent = static_cast<size_t>(response.offset - offset);
+        this->throttle.refund(chunk - sent);
+        if (return_val < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+            errno == EINTR))
+          return true;
+        if (return_val <= 0) {
+          // The client failed or the file was truncated while it was being
+          // sent
+          Metrics::add(Metrics::SendfileErrors);
+          return false;
+        }
+        response.length -= static_cast<int64_t>(sent);
+        budget          -= std::min(budget, sent);
+        this->deadline = std::chrono::steady_clock::now() + timeout;
+      }
+      // Release the file before waiting for the next request
+      this->finishResponse();
+    }
+    // The response has been sent, so the client can be disconnected unless
+    // it asked to keep the connection alive
+    if (this->keep_alive == false) {
+      this->state = State::Closing;
+      return false;
+    }
+    // Move on to the next request, answering it immediately if it was already
+    // received (pipelined) along with the previous one
+    this->request.consume();
+    this->state    = State::Reading;
+    this->deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds{_keepalive};
+    // Records already decrypted by OpenSSL won't make the socket readable
+    if (this->request.complete() == false)
+      return (Tls::pending(this->ssl) ? this->readRequest() : true);
+    if (this->queueResponse() == false)
+      return false;
+  }
+}
@@ -0,0 +1,928 @@
+/**
+ * @file  FileCache.cpp
+ * @brief FileCache
+ *
+ * Class implementation for FileCache
+ *
+ * The FileCache maps absolute (but not yet sandboxed) request paths to files
+ * that have already been resolved through SandboxPath and opened for reading,
+ * along with their size and modification time.  Entries are trusted for a short
+ * interval after they were last checked, after which a single fstatat(...) of
+ * the resolved path (relative to the jail's descriptor) decides whether the
+ * entry is still current
+ *
+ * Each entry also holds its pre-rendered response headers (status line,
+ * Content-Length, Accept-Ranges, Content-Type, Last-Modified and ETag, plus a
+ * 304 Not Modified variant) so that a response can be emitted straight from the
+ * entry without building strings
+ *
+ * When precompressed content is enabled, each entry also refers to the brotli
+ * and gzip sidecars of its file (FILE.br and FILE.gz) if they exist, so that
+ * content negotiation doesn't cost any additional system calls per request
+ *
+ * Files no larger than the inline threshold are also copied into their entry
+ * so that they can be sent along with their header using a single `writev`
+ * instead of paying for a call to `sendfile64`
+ *
+ * Each NUMA node has a cache of its own (so that entries, their inline content
+ * and their reference counts stay in the memory of the node whose threads use
+ * them), split into shards that each evict entries once they hold more than
+ * their share of either the entry capacity or the inline content budget.  Both
+ * are divided between the nodes that the process may run on, so the totals
+ * hold however many nodes there are.  Workers pinned to a CPU use the cache of
+ * its node, while other threads use that of the CPU they are running on
+ *
+ * Lookups don't take a lock: each shard is a fixed table of chains whose links
+ * are atomic pointers, which lookups follow while changes are made in place
+ * under the shard's mutex (one at a time).  An entry that is unlinked is only
+ * freed once every lookup that began before then has finished, as announced by
+ * each thread in a slot of its own.  Rather than moving an entry to the front
+ * of its shard's list when it is served, a hit marks the entry as referenced
+ * (only writing to it if it wasn't already), and eviction gives referenced
+ * entries a second chance instead of discarding them (the CLOCK approximation
+ * of least recently used)
+ *
+ * The cache can be warmed before the server starts accepting clients, loading
+ * the files a client is expected to ask for and asking the kernel to read ahead
+ * any content that isn't held in memory.  Inline content can also be locked in
+ * memory so that it is never paged out under memory pressure
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "include/FileCache.hpp"
+#include "include/Metrics.hpp"
+#include "include/SandboxPath.hpp"
+#include "include/StaticTree.hpp"
+
+// The largest number of NUMA nodes with caches of their own (any others share
+// them)
+#define CACHENODES   8
+// The number of unlinked entries in a shard waiting to be freed before the
+// lookups that might still be reading them are checked
+#define CACHERETIRED 64
+// The number of nanoseconds an entry is trusted before it is checked again
+#define CACHETTL     1000000000
+
+// The directory describing each NUMA node (and its CPUs)
+#define NODEDIR      "/sys/devices/system/node"
+
+// Initialize static members
+size_t                         FileCache::capacity      = 0;
+std::atomic<uint64_t>          FileCache::epoch{1};
+size_t                         FileCache::inline_budget = 64 << 20;
+size_t                         FileCache::inline_max    = 0;
+bool                           FileCache::locked        = false;
+size_t                         FileCache::nodes         = 1;
+std::vector<unsigned>          FileCache::placement{};
+bool                           FileCache::precompressed = false;
+ThreadSlots<FileCache::Reader> FileCache::readers{};
+FileCache::Shard               FileCache::shards[CACHENODES][CACHESHARDS]{};
+
+// The cache node of the calling thread if it is pinned to a CPU, otherwise
+// CACHENODES
+static thread_local unsigned pinned = CACHENODES;
+
+/**
+ * @brief Now
+ *
+ * Fetches a monotonic timestamp for entry bookkeeping
+ *
+ * @return  The current time in nanoseconds
+ */
+static int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief CPU List
+ *
+ * Parses a list of CPUs in the format used by the kernel (e.g. "0-3,8-11")
+ *
+ * @param  list  The list of CPUs
+ *
+ * @return       The CPUs in the list
+ */
+static std::vector<int> cpu_list(const std::string& list) {
+  std::vector<int> cpus{};
+  const char* cursor = list.c_str();
+  char*       end    = nullptr;
+  while (*cursor != '\0') {
+    long first = strtol(cursor, &end, 10), last = first;
+    if (end == cursor)
+      break;
+    if (*end == '-' && (last = strtol(end + 1, &end, 10)) < first)
+      break;
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+      cpus.push_back(static_cast<int>(cpu));
+    cursor = (*end == ',' ? end + 1 : end);
+  }
+  return cpus;
+}
+
+/**
+ * @brief Content Type
+ *
+ * Determines the media type of a file from its extension
+ *
+ * @param  path  The path of the file
+ *
+ * @return       The media type of the file
+ */
+static const char* content_type(const std::string& path) {
+  static const struct { const char* extension; const char* type; } types[] = {
+    {".css",   "text/css"},
+    {".csv",   "text/csv"},
+    {".gif",   "image/gif"},
+    {".htm",   "text/html"},
+    {".html",  "text/html"},
+    {".ico",   "image/x-icon"},
+    {".jpeg",  "image/jpeg"},
+    {".jpg",   "image/jpeg"},
+    {".js",    "application/javascript"},
+    {".json",  "application/json"},
+    {".mjs",   "application/javascript"},
+    {".mp3",   "audio/mpeg"},
+    {".mp4",   "video/mp4"},
+    {".pdf",   "application/pdf"},
+    {".png",   "image/png"},
+    {".svg",   "image/svg+xml"},
+    {".txt",   "text/plain"},
+    {".wasm",  "application/wasm"},
+    {".webm",  "video/webm"},
+    {".webp",  "image/webp"},
+    {".woff",  "font/woff"},
+    {".woff2", "font/woff2"},
+    {".xml",   "application/xml"},
+    {".zip",   "application/zip"}
+  };
+  size_t dot = path.find_last_of("./");
+  if (dot != std::string::npos && path[dot] == '.') {
+    std::string extension{path, dot};
+    for (char& c : extension)
+      c = static_cast<char>(tolower(c));
+    for (const auto& type : types)
+      if (extension == type.extension)
+        return type.type;
+  }
+  return "application/octet-stream";
+}
+
+/**
+ * @brief HTTP Date
+ *
+ * Formats a timestamp as an IMF-fixdate as described in RFC 7231 § 7.1.1.1
+ *
+ * @param  time  The number of seconds since the epoch
+ *
+ * @return       std::string date
+ */
+static std::string http_date(time_t time) {
+  static const char* days[]   = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri",
+    "Sat"};
+  static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+  struct tm tm{};
+  gmtime_r(&time, &tm);
+  char buffer[32] = {};
+  snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+    days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900,
+    tm.tm_hour, tm.tm_min, tm.tm_sec);
+  return buffer;
+}
+
+/**
+ * @brief Footprint
+ *
+ * Determines how much file content an entry (and its sidecars) holds in memory
+ *
+ * @param  entry  The entry to measure
+ *
+ * @return        The number of bytes of inline content
+ */
+static size_t footprint(const FileCache::Entry& entry) {
+  return entry.content.length() +
+    (entry.brotli ? entry.brotli->content.length() : 0) +
+    (entry.gzip   ? entry.gzip->content.length()   : 0);
+}
+
+/**
+ * @brief Unchanged
+ *
+ * Determines if the resolved path of an entry (relative to the jail) still
+ * refers to the same, unmodified file
+ *
+ * @param  entry  The entry to check
+ *
+ * @return        true if the file is unchanged, otherwise false
+ */
+static bool unchanged(const FileCache::Entry& entry) {
+  struct stat info;
+  return SandboxPath::stat(entry.rpath, info) &&
+    info.st_dev          == entry.dev  && info.st_ino          == entry.ino &&
+    info.st_size         == entry.size &&
+    info.st_mtim.tv_sec  == entry.mtime.tv_sec &&
+    info.st_mtim.tv_nsec == entry.mtime.tv_nsec;
+}
+
+/**
+ * @brief Unchanged (Sidecar)
+ *
+ * Determines if a sidecar of an entry is unchanged, including whether it still
+ * exists (or still doesn't exist)
+ *
+ * @param  sidecar  The sidecar entry, if one was found
+ * @param  path     The path at which the sidecar would be found (relative to
+ *                  the jail)
+ *
+ * @return          true if the sidecar is unchanged, otherwise false
+ */
+static bool unchanged(const std::shared_ptr<const FileCache::Entry>& sidecar,
+    const std::string& path) {
+  struct stat info;
+  if (!sidecar)
+    return SandboxPath::stat(path, info) == false;
+  return unchanged(*sidecar);
+}
+
+/**
+ * @brief Entry Destructor
+ *
+ * Closes the file (and unlocks its content) once the last user of the entry has
+ * released it
+ */
+FileCache::Entry::~Entry() {
+  if (this->locked == true)
+    munlock(this->content.data(), this->content.length());
+  if (this->fd >= 0)
+    close(this->fd);
+}
+
+/**
+ * @brief Shard Destructor
+ *
+ * Releases the shard's entries (each closed once it is no longer in use)
+ */
+FileCache::Shard::~Shard() {
+  for (Node* node = this->oldest; node != nullptr;) {
+    Node* newer = node->newer;
+    delete node;
+    node = newer;
+  }
+  for (Node* node : this->retired)
+    delete node;
+  delete[] this->buckets.load();
+}
+
+/**
+ * @brief Evict
+ *
+ * Unlinks an entry from its shard (whose mutex must be held) and forgets it
+ *
+ * @param  shard  The shard
+ * @param  node   The entry
+ */
+void FileCache::evict(Shard& shard, Node* node) {
+  FileCache::link(shard, node->path, node->hash).store(node->next.load());
+  FileCache::forget(shard, node);
+}
+
+/**
+ * @brief Find
+ *
+ * Follows the chain of a shard that would hold the given path (safe without
+ * the shard's mutex while the lookup is announced)
+ *
+ * @param  shard  The shard
+ * @param  path   The absolute (but not yet sandboxed) path
+ * @param  hash   The hash of the path
+ *
+ * @return        The path's entry, or nullptr if it isn't cached
+ */
+FileCache::Node* FileCache::find(const Shard& shard, const std::string& path,
+    size_t hash) {
+  std::atomic<Node*>* buckets = shard.buckets.load();
+  if (buckets == nullptr)
+    return nullptr;
+  for (Node* node = buckets[(hash / CACHESHARDS) & shard.mask].load();
+      node != nullptr; node = node->next.load())
+    if (node->hash == hash && node->path == path)
+      return node;
+  return nullptr;
+}
+
+/**
+ * @brief Forget
+ *
+ * Removes an entry that is no longer linked into its shard (whose mutex must
+ * be held) from the shard's list, freeing it once no lookup can still be
+ * reading it
+ *
+ * @param  shard  The shard
+ * @param  node   The entry
+ */
+void FileCache::forget(Shard& shard, Node* node) {
+  (node->older != nullptr ? node->older->newer : shard.oldest) = node->newer;
+  (node->newer != nullptr ? node->newer->older : shard.newest) = node->older;
+  shard.bytes -= footprint(*node->entry);
+  --shard.count;
+  node->retired = FileCache::epoch.fetch_add(1) + 1;
+  shard.retired.push_back(node);
+  if (shard.retired.size() >= CACHERETIRED)
+    FileCache::reclaim(shard);
+}
+
+/**
+ * @brief Get Capacity
+ *
+ * Fetches the maximum number of entries held by the cache
+ *
+ * @return  The maximum number of entries (zero if the cache is disabled)
+ */
+size_t FileCache::getCapacity() {
+  return FileCache::capacity;
+}
+
+/**
+ * @brief Get Nodes
+ *
+ * Fetches a CPU that the process may run on for each NUMA node with a cache of
+ * its own (see mapNodes)
+ *
+ * @return  The CPU for each node, or -1 for a node whose CPUs aren't known
+ */
+std::vector<int> FileCache::getNodes() {
+  std::vector<int> cpus(FileCache::nodes, -1);
+  for (size_t cpu = 0; cpu < FileCache::placement.size(); ++cpu) {
+    unsigned node = FileCache::placement[cpu];
+    if (node < cpus.size() && cpus[node] < 0)
+      cpus[node] = static_cast<int>(cpu);
+  }
+  return cpus;
+}
+
+/**
+ * @brief Invalidate
+ *
+ * Marks every entry as due to be checked again before it is next served, so
+ * that files changed on disk are reloaded while unchanged ones stay cached
+ * (moving each check back by the same interval keeps the order of eviction)
+ */
+void FileCache::invalidate() {
+  for (auto& node : FileCache::shards)
+    for (Shard& shard : node) {
+      std::unique_lock<std::mutex> lock{shard.mutex};
+      for (Node* node = shard.oldest; node != nullptr; node = node->newer)
+        node->entry->checked -= CACHETTL;
+    }
+}
+
+/**
+ * @brief Link
+ *
+ * Finds the link of a shard's chain (whose mutex must be held) that refers to
+ * the given path's entry, or the empty link at the end of the chain
+ *
+ * @param  shard  The shard
+ * @param  path   The absolute (but not yet sandboxed) path
+ * @param  hash   The hash of the path
+ *
+ * @return        The link
+ */
+std::atomic<FileCache::Node*>& FileCache::link(Shard& shard,
+    const std::string& path, size_t hash) {
+  std::atomic<Node*>* link = &shard.buckets.load()[(hash / CACHESHARDS) &
+    shard.mask];
+  for (Node* node = link->load(); node != nullptr && (node->hash != hash ||
+      node->path != path); node = link->load())
+    link = &node->next;
+  return *link;
+}
+
+/**
+ * @brief Load
+ *
+ * Resolves the given path through SandboxPath and opens the resulting file
+ * along with any precompressed sidecars
+ *
+ * @param  path  The absolute (but not yet sandboxed) path
+ *
+ * @return       A new entry describing the opened file
+ */
+std::shared_ptr<FileCache::Entry> FileCache::load(const std::string& path) {
+  std::shared_ptr<Entry> entry = FileCache::loadFile(path);
+  std::string type{content_type(entry->rpath)};
+  if (FileCache::precompressed == true) {
+    static const struct {
+      const char* extension;
+      const char* encoding;
+      std::shared_ptr<const Entry> Entry::* sidecar;
+    } sidecars[] = {
+      {".br", "br",   &Entry::brotli},
+      {".gz", "gzip", &Entry::gzip}
+    };
+    for (const auto& sidecar : sidecars) {
+      try {
+        std::shared_ptr<Entry> variant = FileCache::loadFile(path +
+          sidecar.extension);
+        FileCache::render(*variant, type, sidecar.encoding, true);
+        (*entry).*sidecar.sidecar = variant;
+      } catch (const std::exception& e) {
+        // Serve the file as-is to clients that would accept this encoding
+      }
+    }
+  }
+  FileCache::render(*entry, type, nullptr, entry->brotli || entry->gzip);
+  entry->checked = now();
+  return entry;
+}
+
+/**
+ * @brief Load File
+ *
+ * Resolves the given path (through the static tree, `openat2` or SandboxPath)
+ * and opens the resulting file, copying it into memory if it is small enough
+ *
+ * @param  path  The absolute (but not yet sandboxed) path
+ *
+ * @return       A new entry describing the opened file (without its headers)
+ */
+std::shared_ptr<FileCache::Entry> FileCache::loadFile(const std::string& path) {
+  std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+  // Look the path up in the static tree instead of resolving it if possible,
+  // otherwise let the kernel resolve and open it beneath the jail (falling
+  // back to resolving it through SandboxPath)
+  std::string rpath{};
+  if (StaticTree::enabled()) {
+    if (StaticTree::find(path, rpath) == false)
+      throw std::runtime_error{"\"" + path + "\" is not in the static tree"};
+  }
+  else if ((entry->fd = SandboxPath::open(path, entry->rpath)) < 0) {
+    SandboxPath sandbox{path};
+    rpath = sandbox.get();
+  }
+  // Open file for reading (remembering where it was found within the jail)
+  if (entry->fd < 0) {
+    entry->rpath = SandboxPath::relative(rpath);
+    entry->fd    = ::open(rpath.c_str(), O_RDONLY | O_CLOEXEC);
+  }
+  if (entry->fd < 0)
+    throw std::runtime_error{"failed to open \"" + rpath + "\""};
+  // Record the identity, size and modification time of the opened file
+  struct stat info;
+  if (fstat(entry->fd, &info) != 0 || !S_ISREG(info.st_mode))
+    throw std::runtime_error{"\"" + entry->rpath + "\" is not a regular file"};
+  entry->size    = info.st_size;
+  entry->mtime   = info.st_mtim;
+  entry->dev     = info.st_dev;
+  entry->ino     = info.st_ino;
+  // Copy small files into memory if they will be cached
+  if (FileCache::capacity > 0 && FileCache::inline_max > 0 &&
+      entry->size >= 0 &&
+      static_cast<size_t>(entry->size) <= FileCache::inline_max) {
+    std::string content(static_cast<size_t>(entry->size), '\0');
+    size_t data_read = 0;
+    ssize_t return_val = 1;
+    while (return_val > 0 && data_read < content.length()) {
+      return_val = pread(entry->fd, &content[data_read],
+        content.length() - data_read, static_cast<off_t>(data_read));
+      if (return_val > 0)
+        data_read += static_cast<size_t>(return_val);
+    }
+    if (data_read == content.length()) {
+      entry->content = std::move(content);
+      entry->inlined = true;
+      // Keep the content resident if requested (it is still served if the
+      // locked memory limit doesn't allow it)
+      if (FileCache::locked == true && entry->content.length() > 0)
+        entry->locked = (mlock(entry->content.data(),
+          entry->content.length()) == 0);
+    }
+  }
+  return entry;
+}
+
+/**
+ * @brief Map Nodes
+ *
+ * Determines the NUMA node of each CPU that the process may run on (from
+ * sysfs), so that the cache of each node is used from its own CPUs and the
+ * capacity and inline content budget are divided between the nodes in use
+ */
+void FileCache::mapNodes() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  DIR* directory = nullptr;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ||
+      (directory = opendir(NODEDIR)) == nullptr)
+    return;
+  std::vector<unsigned long> ids{};
+  while (struct dirent* item = readdir(directory)) {
+    if (strncmp(item->d_name, "node", 4) == 0 &&
+        isdigit(static_cast<unsigned char>(item->d_name[4])))
+      ids.push_back(strtoul(item->d_name + 4, nullptr, 10));
+  }
+  closedir(directory);
+  std::sort(ids.begin(), ids.end());
+  // Number the nodes that have CPUs the process may run on, leaving the others
+  // (and CPUs that can't be used) unmapped
+  std::vector<unsigned> placement(CPU_SETSIZE, CACHENODES);
+  size_t nodes = 0;
+  for (unsigned long id : ids) {
+    std::ifstream input{NODEDIR "/node" + std::to_string(id) + "/cpulist"};
+    std::string list{};
+    bool used = false;
+    std::getline(input, list);
+    for (int cpu : cpu_list(list))
+      if (CPU_ISSET(cpu, &allowed)) {
+        placement[static_cast<size_t>(cpu)] = nodes % CACHENODES;
+        used = true;
+      }
+    if (used == true)
+      ++nodes;
+  }
+  FileCache::nodes     = std::max<size_t>(1, std::min<size_t>(nodes,
+    CACHENODES));
+  FileCache::placement = std::move(placement);
+}
+
+/**
+ * @brief Node
+ *
+ * Determines which cache is used from the given CPU
+ *
+ * @param  cpu  The CPU (or -1 if unknown)
+ *
+ * @return      The cache node of the CPU's NUMA node (the first if unknown)
+ */
+unsigned FileCache::node(int cpu) {
+  if (cpu < 0 || static_cast<size_t>(cpu) >= FileCache::placement.size() ||
+      FileCache::placement[static_cast<size_t>(cpu)] >= CACHENODES)
+    return 0;
+  return FileCache::placement[static_cast<size_t>(cpu)];
+}
+
+/**
+ * @brief Open
+ *
+ * Fetches an open file for the given path from the cache, resolving and
+ * opening it if it isn't cached (or is no longer current)
+ *
+ * @param  path  The absolute (but not yet sandboxed) path
+ *
+ * @return       An entry describing the opened file
+ */
+std::shared_ptr<const FileCache::Entry> FileCache::open(
+    const std::string& path) {
+  // Bypass the cache entirely if it is disabled
+  if (FileCache::capacity == 0) {
+    Metrics::add(Metrics::CacheMisses);
+    return FileCache::load(path);
+  }
+  size_t hash = std::hash<std::string>{}(path);
+  Shard& shard = FileCache::shard(hash);
+  int64_t timestamp = now();
+  std::shared_ptr<Entry> entry{};
+  {
+    // Announce the lookup before following the shard's chains so that nothing
+    // is freed while it's in use (holding off changes to the shard instead if
+    // every reader slot is taken)
+    Reader* reader = FileCache::readers.local();
+    std::unique_lock<std::mutex> lock{shard.mutex, std::defer_lock};
+    if (reader != nullptr)
+      reader->epoch.store(FileCache::epoch.load());
+    else
+      lock.lock();
+    Node* node = FileCache::find(shard, path, hash);
+    if (node != nullptr) {
+      entry = node->entry;
+      // Mark the entry as recently used (only writing to it if it wasn't)
+      if (node->referenced.load(std::memory_order_relaxed) == false)
+        node->referenced.store(true, std::memory_order_relaxed);
+    }
+    if (reader != nullptr)
+      reader->epoch.store(0, std::memory_order_release);
+  }
+  // Serve the cached entry if it was checked recently or is still current
+  if (entry && (timestamp - entry->checked < CACHETTL ||
+      FileCache::revalidate(*entry, timestamp))) {
+    Metrics::add(Metrics::CacheHits);
+    return entry;
+  }
+  Metrics::add(Metrics::CacheMisses);
+  try {
+    entry = FileCache::load(path);
+  } catch (const std::exception& e) {
+    // Forget any stale entry for a path that can no longer be served
+    std::unique_lock<std::mutex> lock{shard.mutex};
+    Node* node = FileCache::find(shard, path, hash);
+    if (node != nullptr)
+      FileCache::evict(shard, node);
+    throw;
+  }
+  std::unique_lock<std::mutex> lock{shard.mutex};
+  FileCache::store(shard, path, hash, entry);
+  return entry;
+}
+
+/**
+ * @brief Pin
+ *
+ * Uses the cache of the given CPU's NUMA node for every lookup made by the
+ * calling thread (which should be pinned to that CPU), instead of that of the
+ * CPU it happens to be running on
+ *
+ * @param  cpu  The CPU to which the thread is pinned, or -1 for none
+ */
+void FileCache::pin(int cpu) {
+  pinned = (cpu >= 0 ? FileCache::node(cpu) : CACHENODES);
+}
+
+/**
+ * @brief Reclaim
+ *
+ * Frees the unlinked entries of a shard (whose mutex must be held) that no
+ * lookup can still be reading
+ *
+ * @param  shard  The shard
+ */
+void FileCache::reclaim(Shard& shard) {
+  // Lookups announced at or after the epoch an entry was unlinked in began
+  // after it was unlinked
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  FileCache::readers.each([&oldest](Reader& reader) {
+    uint64_t epoch = reader.epoch.load();
+    if (epoch != 0)
+      oldest = std::min(oldest, epoch);
+  });
+  auto freed = std::partition(shard.retired.begin(), shard.retired.end(),
+    [oldest](const Node* node) { return node->retired > oldest; });
+  for (auto it = freed; it != shard.retired.end(); ++it)
+    delete *it;
+  shard.retired.erase(freed, shard.retired.end());
+}
+
+/**
+ * @brief Relock
+ *
+ * Locks the inline content of every cached entry that was locked again, since
+ * memory locks are not inherited by a child process (such as the daemon)
+ */
+void FileCache::relock() {
+  for (auto& node : FileCache::shards)
+    for (Shard& shard : node) {
+      std::unique_lock<std::mutex> lock{shard.mutex};
+      for (Node* node = shard.oldest; node != nullptr; node = node->newer)
+        for (const Entry* file : {static_cast<const Entry*>(node->entry.get()),
+            node->entry->brotli.get(), node->entry->gzip.get()})
+          if (file != nullptr && file->locked == true)
+            mlock(file->content.data(), file->content.length());
+    }
+}
+
+/**
+ * @brief Render
+ *
+ * Derives the validators of an opened file and pre-renders its response
+ * headers (everything except the Connection header), keeping the fields that
+ * don't depend on the status separately for partial responses
+ *
+ * @param  entry     The entry to render
+ * @param  type      The media type of the (uncompressed) file
+ * @param  encoding  The Content-Encoding of the file, or nullptr if none
+ * @param  vary      Whether or not the response depends on Accept-Encoding
+ */
+void FileCache::render(Entry& entry, const std::string& type,
+    const char* encoding, bool vary) {
+  // Tag encoded variants so that they never share an entity-tag with the file
+  char etag[64] = {};
+  snprintf(etag, sizeof(etag), "\"%llx-%llx%s%s\"",
+    static_cast<unsigned long long>(entry.mtime.tv_sec),
+    static_cast<unsigned long long>(entry.size),
+    (encoding != nullptr ? "-" : ""), (encoding != nullptr ? encoding : ""));
+  entry.etag          = etag;
+  entry.last_modified = http_date(entry.mtime.tv_sec);
+  std::string validators = "Last-Modified: " + entry.last_modified + "\r\n"
+    "ETag: " + entry.etag + "\r\n" +
+    (vary == true ? "Vary: Accept-Encoding\r\n" : "");
+  entry.fields = "Accept-Ranges: bytes\r\n"
+    "Content-Type: " + type + "\r\n" +
+    (encoding != nullptr ? "Content-Encoding: " + std::string{encoding} +
+      "\r\n" : "") + validators;
+  entry.header = "HTTP/1.1 200 OK\r\n"
+    "Content-Length: " + std::to_string(entry.size) + "\r\n" +
+    entry.fields;
+  entry.not_modified = "HTTP/1.1 304 Not Modified\r\n" + validators;
+}
+
+/**
+ * @brief Revalidate
+ *
+ * Determines if the resolved path of an entry (and each of its sidecars) still
+ * refers to the same, unmodified file, without following a symbolic link at
+ * the end of the path (so files reached through one are reopened instead)
+ *
+ * @param  entry      The entry to check
+ * @param  timestamp  The current time in nanoseconds
+ *
+ * @return            true if the entry is still current, otherwise false
+ */
+bool FileCache::revalidate(Entry& entry, int64_t timestamp) {
+  if (!unchanged(entry) || (FileCache::precompressed == true &&
+      (!unchanged(entry.brotli, entry.rpath + ".br") ||
+       !unchanged(entry.gzip,   entry.rpath + ".gz"))))
+    return false;
+  entry.checked = timestamp;
+  return true;
+}
+
+/**
+ * @brief Set Capacity
+ *
+ * Sets the maximum number of entries held by the cache, divided between the
+ * caches of each NUMA node in use (zero disables it)
+ *
+ * @param  capacity  The maximum number of entries
+ */
+void FileCache::setCapacity(size_t capacity) {
+  FileCache::capacity = capacity;
+}
+
+/**
+ * @brief Set Inline
+ *
+ * Sets the size threshold below which cached files are held in memory and the
+ * total amount of memory that may be used to hold them
+ *
+ * @param  max     The size of the largest file to hold in memory (zero
+ *                 disables inline content)
+ * @param  budget  The total number of bytes of file content to hold in memory
+ *                 (divided between the caches of each NUMA node in use)
+ */
+void FileCache::setInline(size_t max, size_t budget) {
+  FileCache::inline_max    = max;
+  FileCache::inline_budget = budget;
+}
+
+/**
+ * @brief Set Locked
+ *
+ * Sets whether or not inline content is locked in memory, raising the locked
+ * memory limit to cover the inline content budget where possible (so this
+ * should be called before privileges are dropped)
+ *
+ * @param  locked  Whether or not to lock inline content in memory
+ */
+void FileCache::setLocked(bool locked) {
+  FileCache::locked = locked;
+  struct rlimit limit{};
+  if (locked == false || getrlimit(RLIMIT_MEMLOCK, &limit) != 0)
+    return;
+  // Allow for each of an entry's buffers to straddle an additional page
+  rlim_t needed = static_cast<rlim_t>(FileCache::inline_budget +
+    FileCache::capacity * 3 * static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+  if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < needed) {
+    limit.rlim_cur = needed;
+    if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < needed)
+      limit.rlim_max = needed;
+    setrlimit(RLIMIT_MEMLOCK, &limit);
+  }
+}
+
+/**
+ * @brief Set Precompressed
+ *
+ * Sets whether or not brotli and gzip sidecars are looked up for each file
+ *
+ * @param  precompressed  Whether or not to serve precompressed sidecars
+ */
+void FileCache::setPrecompressed(bool precompressed) {
+  FileCache::precompressed = precompressed;
+}
+
+/**
+ * @brief Shard
+ *
+ * Determines which shard holds the path with the given hash in the calling
+ * thread's cache: that of the node of the CPU it was pinned to (see pin), or
+ * otherwise of the CPU it is currently running on
+ *
+ * @param  hash  The hash of the absolute (but not yet sandboxed) path
+ *
+ * @return       The shard holding the path
+ */
+FileCache::Shard& FileCache::shard(size_t hash) {
+  unsigned node = (pinned < CACHENODES ? pinned :
+    FileCache::node(sched_getcpu()));
+  return FileCache::shards[node][hash % CACHESHARDS];
+}
+
+/**
+ * @brief Store
+ *
+ * Adds an entry to a shard (whose mutex must be held) in place of any previous
+ * entry for its path, then evicts the least recently used entries beyond the
+ * shard's share of either the capacity or the inline content budget
+ *
+ * @param  shard  The shard
+ * @param  path   The absolute (but not yet sandboxed) path
+ * @param  hash   The hash of the path
+ * @param  entry  The entry
+ */
+void FileCache::store(Shard& shard, const std::string& path, size_t hash,
+    std::shared_ptr<Entry> entry) {
+  size_t shards = FileCache::nodes * CACHESHARDS;
+  size_t limit  = std::max<size_t>(1, FileCache::capacity      / shards);
+  size_t bytes  = std::max<size_t>(1, FileCache::inline_budget / shards);
+  // Size the table for the shard's share of the capacity the first time it's
+  // used (it never changes, so lookups can follow it without a lock)
+  if (shard.buckets.load() == nullptr) {
+    size_t count = 16;
+    while (count < limit)
+      count <<= 1;
+    shard.mask = count - 1;
+    shard.buckets.store(new std::atomic<Node*>[count]());
+  }
+  Node* node  = new Node{};
+  node->entry = std::move(entry);
+  node->hash  = hash;
+  node->path  = path;
+  // Take the place of the previous entry in its chain (or join the end of the
+  // chain) so that lookups for the path always find one of them
+  std::atomic<Node*>& link = FileCache::link(shard, path, hash);
+  Node* previous = link.load();
+  if (previous != nullptr)
+    node->next.store(previous->next.load());
+  link.store(node);
+  if (previous != nullptr)
+    FileCache::forget(shard, previous);
+  node->older = shard.newest;
+  (shard.newest != nullptr ? shard.newest->newer : shard.oldest) = node;
+  shard.newest = node;
+  shard.bytes += footprint(*node->entry);
+  ++shard.count;
+  // Evict the least recently used entries beyond this shard's capacity, moving
+  // any that were served since they were last considered to the newest end
+  while (shard.count > limit || (shard.bytes > bytes && shard.count > 1)) {
+    Node* oldest = shard.oldest;
+    if (oldest->referenced.exchange(false) == false) {
+      FileCache::evict(shard, oldest);
+      continue;
+    }
+    shard.oldest        = oldest->newer;
+    shard.oldest->older = nullptr;
+    oldest->newer       = nullptr;
+    oldest->older       = shard.newest;
+    shard.newest->newer = oldest;
+    shard.newest        = oldest;
+  }
+}
+
+/**
+ * @brief Warm
+ *
+ * Loads the given path into the cache and asks the kernel to read ahead any of
+ * its content (or that of its sidecars) that isn't held in memory
+ *
+ * @param  path  The absolute (but not yet sandboxed) path
+ *
+ * @return       true if the path could be served, otherwise false
+ */
+bool FileCache::warm(const std::string& path) {
+  std::shared_ptr<const Entry> entry{};
+  try {
+    entry = FileCache::open(path);
+  } catch (const std::exception& e) {
+    return false;
+  }
+  for (const Entry* file : {entry.get(), entry->brotli.get(),
+      entry->gzip.get()})
+    if (file != nullptr && file->inlined == false && file->fd >= 0)
+      posix_fadvise(file->fd, 0, 0, POSIX_FADV_WILLNEED);
+  return true;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file  IoRing.cpp
+ * @brief IoRing
+ *
+ * Class implementation for IoRing
+ *
+ * An IoRing is a single io_uring instance, set up and driven directly through
+ * its system calls: submission queue entries are filled in place in the shared
+ * submission ring and all of them are handed to the kernel by the next call to
+ * `submit`, which also waits for completions, so a whole batch of operations
+ * costs a single system call
+ *
+ * An IoRing must only be used by one thread, and is only built where the
+ * io_uring header is available
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "include/IoRing.hpp"
+
+/**
+ * @brief IoRing Constructor
+ *
+ * Creates an io_uring instance and maps its rings into memory
+ *
+ * @param  entries  The number of submission queue entries
+ */
+IoRing::IoRing(unsigned entries) {
+  struct io_uring_params params{};
+  this->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (this->fd < 0)
+    throw std::runtime_error{"failed to create io_uring instance"};
+  this->sq_ring_size = params.sq_off.array + params.sq_entries *
+    sizeof(unsigned);
+  this->cq_ring_size = params.cq_off.cqes  + params.cq_entries *
+    sizeof(struct io_uring_cqe);
+  // Both rings share a single mapping on kernels since 5.4
+  bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single == true)
+    this->sq_ring_size = this->cq_ring_size = std::max(this->sq_ring_size,
+      this->cq_ring_size);
+  void* sq_ring = mmap(nullptr, this->sq_ring_size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQ_RING);
+  this->sq_ring = (sq_ring != MAP_FAILED ? sq_ring : nullptr);
+  void* cq_ring = (single == true ? sq_ring : mmap(nullptr, this->cq_ring_size,
+    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd,
+    IORING_OFF_CQ_RING));
+  this->cq_ring = (cq_ring != MAP_FAILED ? cq_ring : nullptr);
+  this->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, this->sqes_size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQES);
+  this->sqes = (sqes != MAP_FAILED ? static_cast<struct io_uring_sqe*>(sqes) :
+    nullptr);
+  if (this->sq_ring == nullptr || this->cq_ring == nullptr ||
+      this->sqes == nullptr) {
+    this->unmap();
+    throw std::runtime_error{"failed to map io_uring instance"};
+  }
+  char* sq = static_cast<char*>(this->sq_ring);
+  this->sq_head    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  this->sq_tail    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  this->sq_mask    = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  this->sq_array   = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  this->sq_entries = params.sq_entries;
+  this->tail       = *this->sq_tail;
+  char* cq = static_cast<char*>(this->cq_ring);
+  this->cq_head    = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  this->cq_tail    = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  this->cq_mask    = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  this->cqes       = reinterpret_cast<struct io_uring_cqe*>(cq +
+    params.cq_off.cqes);
+}
+
+/**
+ * @brief IoRing Destructor
+ *
+ * Unmaps the rings and closes the io_uring instance (cancelling any operations
+ * that are still in flight)
+ */
+IoRing::~IoRing() {
+  this->unmap();
+}
+
+/**
+ * @brief Next
+ *
+ * Claims the next submission queue entry, submitting the queued entries first
+ * if the submission queue is full
+ *
+ * @return  A zeroed submission queue entry, which is submitted by the next
+ *          call to `submit`
+ */
+struct io_uring_sqe* IoRing::next() {
+  if (this->tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE) >=
+      this->sq_entries) {
+    this->submit(0);
+    if (this->tail - __atomic_load_n(this->sq_head, __ATOMIC_ACQUIRE) >=
+        this->sq_entries)
+      throw std::runtime_error{"io_uring submission queue is full"};
+  }
+  unsigned index = this->tail & *this->sq_mask;
+  struct io_uring_sqe* sqe = &this->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  this->sq_array[index] = index;
+  ++this->tail;
+  ++this->queued;
+  return sqe;
+}
+
+/**
+ * @brief Submit
+ *
+ * Hands every queued submission queue entry to the kernel
+ *
+ * @param  wait  The number of completions to wait for
+ *
+ * @return       The number of entries submitted, or -1 on failure (see errno)
+ */
+int IoRing::submit(unsigned wait) {
+  __atomic_store_n(this->sq_tail, this->tail, __ATOMIC_RELEASE);
+  int submitted = static_cast<int>(syscall(__NR_io_uring_enter, this->fd,
+    this->queued, wait, (wait > 0 ? IORING_ENTER_GETEVENTS : 0), nullptr, 0));
+  if (submitted > 0)
+    this->queued -= std::min(this->queued, static_cast<unsigned>(submitted));
+  return submitted;
+}
+
+/**
+ * @brief Unmap
+ *
+ * Releases the mappings of the rings and the io_uring instance itself
+ */
+void IoRing::unmap() {
+  if (this->sqes != nullptr)
+    munmap(this->sqes, this->sqes_size);
+  if (this->cq_ring != nullptr && this->cq_ring != this->sq_ring)
+    munmap(this->cq_ring, this->cq_ring_size);
+  if (this->sq_ring != nullptr)
+    munmap(this->sq_ring, this->sq_ring_size);
+  if (this->fd >= 0)
+    close(this->fd);
+  this->sqes    = nullptr;
+  this->cq_ring = nullptr;
+  this->sq_ring = nullptr;
+  this->fd      = -1;
+}
+
+#endif
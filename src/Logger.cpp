@@ -0,0 +1,179 @@
+/**
+ * @file  Logger.cpp
+ * @brief Logger
+ *
+ * Class implementation for Logger
+ *
+ * The Logger moves formatting and syslog(...) off of the threads that serve
+ * clients: each thread copies the format and arguments of its messages into a
+ * single-producer, single-consumer ring of its own without taking any locks,
+ * and one background writer thread drains every ring, formats each message
+ * and writes it to the system logger.  A thread whose ring is full drops its
+ * message instead of waiting (and the number dropped is logged later)
+ *
+ * Rings are never freed; when a thread exits, its ring is left for the next
+ * new thread to claim so that a thread per client doesn't allocate a ring per
+ * client (see ThreadRings).  Messages logged before the writer is started (or
+ * by a thread that couldn't claim a ring) are written synchronously
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <syslog.h>
+#include <thread>
+#include "include/Logger.hpp"
+
+// Initialize static members
+std::mutex                    Logger::mutex{};
+ThreadRings<Logger::Record, LOGRECORDS, LOGRINGS> Logger::rings{};
+std::atomic<bool>             Logger::running{false};
+std::thread                   Logger::writer{};
+
+/**
+ * @brief Drain
+ *
+ * Writes every message waiting in each ring
+ *
+ * @return  true if any messages were written, otherwise false
+ */
+bool Logger::drain() {
+  return Logger::rings.drain(Logger::write, [](size_t dropped) {
+    Record record;
+    record.format = "dropped {} debug messages";
+    Logger::pack(record, dropped);
+    Logger::write(record);
+  });
+}
+
+/**
+ * @brief Pack Text
+ *
+ * Copies a text argument into a message, truncating it to fit
+ *
+ * @param  record  The message
+ * @param  data    The text
+ * @param  length  The length of the text
+ */
+void Logger::packText(Record& record, const char* data, size_t length) {
+  if (record.count >= LOGARGS)
+    return;
+  if (length > static_cast<size_t>(LOGTEXT - record.used))
+    length = static_cast<size_t>(LOGTEXT - record.used);
+  if (length > 0)
+    memcpy(record.text + record.used, data, length);
+  record.kinds[record.count]   = Record::Kind::Text;
+  record.numbers[record.count] = record.used;
+  record.lengths[record.count] = static_cast<uint16_t>(length);
+  record.used  = static_cast<uint16_t>(record.used + length);
+  ++record.count;
+}
+
+/**
+ * @brief Run
+ *
+ * Drains the rings until the logger is stopped, sleeping briefly whenever
+ * they are all empty
+ */
+void Logger::run() {
+  while (Logger::running.load()) {
+    if (Logger::drain() == false)
+      std::this_thread::sleep_for(std::chrono::milliseconds{2});
+  }
+  Logger::drain();
+}
+
+/**
+ * @brief Start
+ *
+ * Starts the background writer thread (which must happen after the process
+ * has daemonized, since threads don't survive `fork`)
+ */
+void Logger::start() {
+  bool running = false;
+  if (Logger::running.compare_exchange_strong(running, true)) {
+    Logger::writer = std::thread{Logger::run};
+    atexit(Logger::stop);
+  }
+}
+
+/**
+ * @brief Stop
+ *
+ * Stops the background writer thread once every waiting message is written
+ */
+void Logger::stop() {
+  Logger::running.store(false);
+  if (Logger::writer.joinable())
+    Logger::writer.join();
+}
+
+/**
+ * @brief Submit
+ *
+ * Places a message in the calling thread's ring (or writes it immediately if
+ * the writer isn't running or the thread has no ring)
+ *
+ * @param  record  The message
+ */
+void Logger::submit(const Record& record) {
+  // Copy only the part of the text that is in use
+  if (Logger::running.load(std::memory_order_relaxed) == false ||
+      Logger::rings.push([&record](Record& slot) {
+        memcpy(&slot, &record, offsetof(Record, text) + record.used);
+      }) == false)
+    Logger::write(record);
+}
+
+/**
+ * @brief Write
+ *
+ * Formats a message and writes it to the system logger
+ *
+ * @param  record  The message
+ */
+void Logger::write(const Record& record) {
+  std::string line{};
+  line.reserve(256);
+  uint8_t index = 0;
+  for (const char* c = record.format; *c != '\0'; ++c) {
+    if (c[0] == '{' && c[1] == '}' && index < record.count) {
+      char number[24] = {};
+      switch (record.kinds[index]) {
+        case Record::Kind::Signed:
+          snprintf(number, sizeof(number), "%lld",
+            static_cast<long long>(record.numbers[index]));
+          line += number;
+          break;
+        case Record::Kind::Unsigned:
+          snprintf(number, sizeof(number), "%llu",
+            static_cast<unsigned long long>(record.numbers[index]));
+          line += number;
+          break;
+        case Record::Kind::Text:
+          line.append(record.text + record.numbers[index],
+            record.lengths[index]);
+          break;
+      }
+      ++index;
+      ++c;
+    }
+    else
+      line += *c;
+  }
+  std::unique_lock<std::mutex> lock{Logger::mutex};
+  if (record.error == true)
+    // Print the given message with the appropriate error string
+    syslog(LOG_DEBUG, "%s: %s", line.c_str(), strerror(record.errnum));
+  else
+    // Print the given message
+    syslog(LOG_DEBUG, "%s",     line.c_str());
+}
@@ -0,0 +1,370 @@
+/**
+ * @file  Metrics.cpp
+ * @brief Metrics
+ *
+ * Class implementation for Metrics
+ *
+ * Metrics keeps counters and latency histograms for each thread in a slot of
+ * its own (see ThreadSlots), padded so that no two threads write to the same
+ * cache line.  Since each slot only has one writer, updating it is a relaxed
+ * load and store instead of a locked read-modify-write
+ *
+ * Each histogram counts latencies in buckets that are an eighth of a power of
+ * two nanoseconds wide, which keeps every quantile within 12.5% of the true
+ * value.  The slots of every thread are summed when the metrics are requested
+ * from the admin port (which only listens on the loopback interface) and are
+ * served in the Prometheus text format, with each latency as a summary of its
+ * 50th, 90th, 99th and 99.9th percentiles
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "include/Metrics.hpp"
+#include "include/slwhttp.hpp"
+
+// Initialize static members
+std::atomic<bool>             Metrics::running{false};
+ThreadSlots<Metrics::Slot>    Metrics::slots{};
+std::atomic<int>              Metrics::sockfd{-1};
+
+/**
+ * @brief Add
+ *
+ * Adds to one of the calling thread's counters
+ *
+ * @param  counter  The counter
+ * @param  value    The amount to add
+ */
+void Metrics::add(Counter counter, uint64_t value) {
+  if (Metrics::enabled() == false)
+    return;
+  Slot* slot = Metrics::slots.local();
+  if (slot == nullptr)
+    return;
+  std::atomic<uint64_t>& total = slot->counters[counter];
+  total.store(total.load(std::memory_order_relaxed) + value,
+    std::memory_order_relaxed);
+}
+
+/**
+ * @brief Bucket
+ *
+ * Determines which histogram bucket counts a latency
+ *
+ * @param  nanoseconds  The latency
+ *
+ * @return              The index of the bucket
+ */
+size_t Metrics::bucket(uint64_t nanoseconds) {
+  if (nanoseconds < 8)
+    return static_cast<size_t>(nanoseconds);
+  // Use the power of two and the next three bits below it
+  int    exponent = 63 - __builtin_clzll(nanoseconds);
+  size_t index    = static_cast<size_t>(exponent - 2) * 8 +
+    static_cast<size_t>((nanoseconds >> (exponent - 3)) & 7);
+  return (index < METRICSBUCKETS ? index : METRICSBUCKETS - 1);
+}
+
+/**
+ * @brief Enabled
+ *
+ * Determines if the admin port is listening
+ *
+ * @return  true if metrics should be collected, otherwise false
+ */
+bool Metrics::enabled() {
+  return Metrics::sockfd.load(std::memory_order_relaxed) >= 0;
+}
+
+/**
+ * @brief Listen
+ *
+ * Prepares the admin port on the loopback interface, or adopts the admin
+ * socket handed over by the process this one replaced
+ *
+ * @param  port    The port number
+ * @param  sockfd  The inherited listening socket, or -1 to create one
+ */
+void Metrics::listen(int port, int sockfd) {
+  if (sockfd >= 0) {
+    debug("serving metrics on inherited 127.0.0.1:{}", port);
+    Metrics::sockfd.store(sockfd);
+    return;
+  }
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family      = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port        = htons(port);
+  sockfd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sockfd < 0)
+    throw std::runtime_error{"failed to create metrics socket"};
+  int yes = 1;
+  struct timeval timeout{1, 0};
+  if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0 ||
+      setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+        sizeof(timeout)) < 0 ||
+      setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+        sizeof(timeout)) < 0) {
+    close(sockfd);
+    throw std::runtime_error{"failed to set metrics socket options"};
+  }
+  if (bind(sockfd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+      ::listen(sockfd, 16) < 0) {
+    close(sockfd);
+    throw std::runtime_error{"failed to listen on 127.0.0.1:" +
+      std::to_string(port)};
+  }
+  debug("serving metrics on 127.0.0.1:{}", port);
+  Metrics::sockfd.store(sockfd);
+}
+
+/**
+ * @brief Listener
+ *
+ * Fetches the admin port's listening socket (to hand it to a new process)
+ *
+ * @return  The listening socket, or -1 if metrics are disabled
+ */
+int Metrics::listener() {
+  return Metrics::sockfd.load();
+}
+
+/**
+ * @brief Record
+ *
+ * Counts the latency of one stage of a request in the calling thread's
+ * histogram for that stage
+ *
+ * @param  stage    The stage
+ * @param  elapsed  The time taken by the stage
+ */
+void Metrics::record(Stage stage,
+    std::chrono::steady_clock::duration elapsed) {
+  if (Metrics::enabled() == false)
+    return;
+  Slot* slot = Metrics::slots.local();
+  if (slot == nullptr)
+    return;
+  int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    elapsed).count();
+  uint64_t value = static_cast<uint64_t>(nanoseconds > 0 ? nanoseconds : 0);
+  Histogram& histogram = slot->histograms[stage];
+  std::atomic<uint64_t>& count = histogram.buckets[Metrics::bucket(value)];
+  count.store(count.load(std::memory_order_relaxed) + 1,
+    std::memory_order_relaxed);
+  histogram.sum.store(histogram.sum.load(std::memory_order_relaxed) + value,
+    std::memory_order_relaxed);
+}
+
+/**
+ * @brief Render
+ *
+ * Sums the metrics of every thread in the Prometheus text format
+ *
+ * @return  std::string metrics
+ */
+std::string Metrics::render() {
+  uint64_t counters[Counters] = {};
+  uint64_t sums[Stages]       = {};
+  std::vector<uint64_t> buckets(Stages * METRICSBUCKETS, 0);
+  Metrics::slots.each([&](const Slot& slot) {
+    for (size_t i = 0; i < Counters; ++i)
+      counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < Stages; ++i) {
+      const Histogram& histogram = slot.histograms[i];
+      for (size_t j = 0; j < METRICSBUCKETS; ++j)
+        buckets[i * METRICSBUCKETS + j] +=
+          histogram.buckets[j].load(std::memory_order_relaxed);
+      sums[i] += histogram.sum.load(std::memory_order_relaxed);
+    }
+  });
+
+  std::string out{};
+  char line[256] = {};
+  const struct { const char* name; const char* help; Counter counter; }
+    totals[] = {
+    {"accepts",         "Clients accepted",                      Accepts},
+    {"rejects",         "Clients turned away at the connection limit",
+      Rejects},
+    {"sent_bytes",      "Response body bytes sent",              SentBytes},
+    {"cache_hits",      "Files served from the file cache",      CacheHits},
+    {"cache_misses",    "Files opened and resolved on request",  CacheMisses},
+    {"sendfile_errors", "Files that could not be completely sent",
+      SendfileErrors}
+  };
+  for (const auto& total : totals) {
+    snprintf(line, sizeof(line), "# HELP slwhttp_%s_total %s.\n"
+      "# TYPE slwhttp_%s_total counter\nslwhttp_%s_total %llu\n", total.name,
+      total.help, total.name, total.name,
+      static_cast<unsigned long long>(counters[total.counter]));
+    out += line;
+  }
+  out += "# HELP slwhttp_requests_total Responses by status code.\n"
+    "# TYPE slwhttp_requests_total counter\n";
+  const struct { const char* code; Counter counter; } statuses[] = {
+    {"200", Status200}, {"206", Status206}, {"304", Status304},
+    {"403", Status403}, {"416", Status416}, {"503", Status503},
+    {"other", StatusOther}
+  };
+  for (const auto& status : statuses) {
+    snprintf(line, sizeof(line), "slwhttp_requests_total{code=\"%s\"} %llu\n",
+      status.code, static_cast<unsigned long long>(counters[status.counter]));
+    out += line;
+  }
+
+  const struct { const char* name; const char* help; } stages[Stages] = {
+    {"header_read", "Time from the first byte of a request until its headers "
+      "were complete"},
+    {"resolve",     "Time taken to resolve and open the requested file"},
+    {"first_byte",  "Time from complete request headers until the response "
+      "header was sent"},
+    {"request",     "Time from complete request headers until the response "
+      "was sent"}
+  };
+  const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+  for (size_t i = 0; i < Stages; ++i) {
+    const uint64_t* histogram = &buckets[i * METRICSBUCKETS];
+    uint64_t count = 0;
+    for (size_t j = 0; j < METRICSBUCKETS; ++j)
+      count += histogram[j];
+    snprintf(line, sizeof(line), "# HELP slwhttp_%s_seconds %s.\n"
+      "# TYPE slwhttp_%s_seconds summary\n", stages[i].name, stages[i].help,
+      stages[i].name);
+    out += line;
+    for (double quantile : quantiles) {
+      // Report the upper bound of the bucket holding the quantile
+      uint64_t rank  = static_cast<uint64_t>(quantile *
+        static_cast<double>(count) + 0.999999);
+      uint64_t seen  = 0;
+      uint64_t value = 0;
+      for (size_t j = 0; j < METRICSBUCKETS && count > 0; ++j) {
+        seen += histogram[j];
+        if (seen >= rank) {
+          value = Metrics::upper(j);
+          break;
+        }
+      }
+      snprintf(line, sizeof(line), "slwhttp_%s_seconds{quantile=\"%g\"} "
+        "%.9f\n", stages[i].name, quantile, static_cast<double>(value) / 1e9);
+      out += line;
+    }
+    snprintf(line, sizeof(line), "slwhttp_%s_seconds_sum %.9f\n"
+      "slwhttp_%s_seconds_count %llu\n", stages[i].name,
+      static_cast<double>(sums[i]) / 1e9, stages[i].name,
+      static_cast<unsigned long long>(count));
+    out += line;
+  }
+  return out;
+}
+
+/**
+ * @brief Run
+ *
+ * Answers each request to the admin port with the current metrics
+ */
+void Metrics::run() {
+  static const std::string missing{"HTTP/1.1 404 Not Found\r\n"
+    "Content-Length: 0\r\nConnection: close\r\n\r\n"};
+  while (true) {
+    int clifd = accept4(Metrics::sockfd.load(), NULL, NULL, SOCK_CLOEXEC);
+    if (clifd < 0) {
+      if (errno != EINTR)
+        debug_error("error accepting metrics client");
+      continue;
+    }
+    // Read the request headers (the accepted socket inherits the timeout)
+    char   request[1024] = {};
+    size_t length        = 0;
+    while (length < sizeof(request) - 1 &&
+        strstr(request, "\r\n\r\n") == nullptr &&
+        strstr(request, "\n\n") == nullptr) {
+      ssize_t data_read = read(clifd, request + length,
+        sizeof(request) - 1 - length);
+      if (data_read < 0 && errno == EINTR)
+        continue;
+      if (data_read <= 0)
+        break;
+      length += static_cast<size_t>(data_read);
+    }
+    if (strncmp(request, "GET /metrics", 12) == 0 &&
+        (request[12] == ' ' || request[12] == '?' || request[12] == '\r' ||
+         request[12] == '\n')) {
+      std::string body = Metrics::render();
+      safe_write(clifd, "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.length()) + "\r\n"
+        "Connection: close\r\n\r\n" + body);
+    }
+    else
+      safe_write(clifd, missing);
+    shutdown(clifd, SHUT_RDWR);
+    close(clifd);
+  }
+}
+
+/**
+ * @brief Served
+ *
+ * Counts a response by its status code, along with the size of its body
+ *
+ * @param  status  The status code of the response
+ * @param  bytes   The number of body bytes sent
+ */
+void Metrics::served(int status, int64_t bytes) {
+  switch (status) {
+    case 200: Metrics::add(Status200);   break;
+    case 206: Metrics::add(Status206);   break;
+    case 304: Metrics::add(Status304);   break;
+    case 403: Metrics::add(Status403);   break;
+    case 416: Metrics::add(Status416);   break;
+    case 503: Metrics::add(Status503);   break;
+    default:  Metrics::add(StatusOther); break;
+  }
+  if (bytes > 0)
+    Metrics::add(SentBytes, static_cast<uint64_t>(bytes));
+}
+
+/**
+ * @brief Start
+ *
+ * Starts the thread that serves the admin port (which must happen after the
+ * process has daemonized, since threads don't survive `fork`)
+ */
+void Metrics::start() {
+  bool running = false;
+  if (Metrics::enabled() &&
+      Metrics::running.compare_exchange_strong(running, true))
+    std::thread{Metrics::run}.detach();
+}
+
+/**
+ * @brief Upper
+ *
+ * Determines the largest latency counted by a histogram bucket
+ *
+ * @param  bucket  The index of the bucket
+ *
+ * @return         The latency in nanoseconds
+ */
+uint64_t Metrics::upper(size_t bucket) {
+  if (bucket < 8)
+    return static_cast<uint64_t>(bucket);
+  size_t exponent = bucket / 8 + 2;
+  return ((static_cast<uint64_t>(9 + bucket % 8)) << (exponent - 3)) - 1;
+}
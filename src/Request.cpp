@@ -0,0 +1,314 @@
+/**
+ * @file  Request.cpp
+ * @brief Request
+ *
+ * Class implementation for Request
+ *
+ * A Request borrows a fixed-size receive buffer from a BufferPool that the
+ * client's data is read into directly, and finds the end of the request headers
+ * (an empty line terminated by either CRLF or a bare LF) in place, resuming the
+ * search where the last chunk left off.  The buffer is only held while data is
+ * pending, so idle keep-alive connections don't hold one
+ *
+ * Once complete, the request line and header fields are parsed into views of
+ * the receive buffer, so parsing a request never allocates memory.  The views
+ * remain valid until consume() is called
+ *
+ * Any bytes received after the end of the request headers are kept so that
+ * pipelined requests can be answered in order after calling consume()
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cctype>
+#include <cstring>
+#include "include/BufferPool.hpp"
+#include "include/Request.hpp"
+#include "include/View.hpp"
+
+/**
+ * @brief Request Constructor
+ *
+ * Creates an empty request that borrows its receive buffer from the given pool
+ *
+ * @param  pool  The pool of MAXHEADERS sized buffers
+ */
+Request::Request(BufferPool& pool): pool(pool) {}
+
+/**
+ * @brief Request Destructor
+ *
+ * Returns the receive buffer (if held) to its pool
+ */
+Request::~Request() {
+  this->pool.release(this->buffer);
+}
+
+/**
+ * @brief Complete
+ *
+ * Determines if the end of the request headers has been received
+ *
+ * @return  true if the request headers are complete, otherwise false
+ */
+bool Request::complete() const {
+  return this->end > 0;
+}
+
+/**
+ * @brief Consume
+ *
+ * Discards the completed request headers and begins searching for the end of
+ * the next (pipelined) request in any data that was received after them
+ */
+void Request::consume() {
+  this->length -= this->end;
+  if (this->length > 0)
+    memmove(this->buffer, this->buffer + this->end, this->length);
+  else {
+    // Give the buffer back while the connection is idle
+    this->pool.release(this->buffer);
+    this->buffer = nullptr;
+  }
+  this->end     = 0;
+  this->scanned = 0;
+  this->count   = 0;
+  this->method  = View{};
+  this->target  = View{};
+  this->version = View{};
+  this->scan();
+  if (this->complete())
+    this->parse();
+}
+
+/**
+ * @brief Get Method
+ *
+ * Fetches the method of the completed request
+ *
+ * @return  View method
+ */
+View Request::getMethod() const {
+  return this->method;
+}
+
+/**
+ * @brief Get Target
+ *
+ * Fetches the (still percent-encoded) target of the completed request
+ *
+ * @return  View target
+ */
+View Request::getTarget() const {
+  return this->target;
+}
+
+/**
+ * @brief Get Version
+ *
+ * Fetches the protocol version of the completed request
+ *
+ * @return  View version, or an empty view if none was provided
+ */
+View Request::getVersion() const {
+  return this->version;
+}
+
+/**
+ * @brief Header
+ *
+ * Fetches the value of the first request header with the given name
+ *
+ * @param  name  The lowercase name of the header
+ *
+ * @return       View value, or an empty view if it wasn't provided
+ */
+View Request::header(const char* name) const {
+  for (size_t i = 0; i < this->count; ++i)
+    if (this->fields[i].name.iequals(name))
+      return this->fields[i].value;
+  return View{};
+}
+
+/**
+ * @brief Keep Alive
+ *
+ * Determines if the client asked for the connection to persist after the
+ * response to this request, which is the default for HTTP/1.1 and must be
+ * requested using "Connection: keep-alive" by HTTP/1.0 clients
+ *
+ * @return  true if the connection should persist, otherwise false
+ */
+bool Request::keepAlive() const {
+  bool persistent = this->version.iequals("http/1.1");
+  View connection = this->header("connection");
+  size_t start = 0;
+  while (start < connection.length) {
+    size_t stop = connection.find(',', start);
+    if (stop == View::npos)
+      stop = connection.length;
+    View token = connection.substr(start, stop - start).trim();
+    if (token.iequals("close"))
+      return false;
+    if (token.iequals("keep-alive"))
+      persistent = true;
+    start = stop + 1;
+  }
+  return persistent;
+}
+
+/**
+ * @brief Lines
+ *
+ * Splits the completed request headers into lines without their line endings
+ *
+ * @param[out]  lines  The views that should receive the lines
+ * @param[in]   max    The maximum number of lines to fetch
+ *
+ * @return             The number of lines fetched
+ */
+size_t Request::lines(View* lines, size_t max) const {
+  size_t count = 0;
+  size_t start = 0;
+  while (start < this->end && count < max) {
+    const char* eol = static_cast<const char*>(memchr(this->buffer + start,
+      '\n', this->end - start));
+    size_t stop = static_cast<size_t>(eol - this->buffer);
+    // Strip the carriage return of a CRLF line ending
+    size_t length = stop - start;
+    if (length > 0 && this->buffer[stop - 1] == '\r')
+      --length;
+    if (length > 0)
+      lines[count++] = View{this->buffer + start, length};
+    start = stop + 1;
+  }
+  return count;
+}
+
+/**
+ * @brief Overflow
+ *
+ * Determines if the client has filled the receive buffer without completing
+ * its request headers
+ *
+ * @return  true if the request should be abandoned, otherwise false
+ */
+bool Request::overflow() const {
+  return this->complete() == false && this->length == MAXHEADERS;
+}
+
+/**
+ * @brief Parse
+ *
+ * Splits the completed request headers into the request line and a list of
+ * header fields (keeping only the first MAXFIELDS fields)
+ */
+void Request::parse() {
+  bool   first = true;
+  size_t start = 0;
+  while (start < this->end) {
+    const char* eol = static_cast<const char*>(memchr(this->buffer + start,
+      '\n', this->end - start));
+    size_t stop = static_cast<size_t>(eol - this->buffer);
+    View   line{this->buffer + start, stop - start};
+    start = stop + 1;
+    line  = line.trim();
+    if (line.empty())
+      continue;
+    if (first == true) {
+      // The request line consists of the method, target and version
+      first = false;
+      View* words[] = {&this->method, &this->target, &this->version};
+      size_t offset = 0;
+      for (View* word : words) {
+        while (offset < line.length && line.data[offset] == ' ')
+          ++offset;
+        size_t space = line.find(' ', offset);
+        if (space == View::npos)
+          space = line.length;
+        *word  = line.substr(offset, space - offset);
+        offset = space;
+      }
+      continue;
+    }
+    // Each following line is a header field in the form "Name: value"
+    size_t colon = line.find(':');
+    if (colon != View::npos && this->count < MAXFIELDS) {
+      this->fields[this->count].name  = line.substr(0, colon).trim();
+      this->fields[this->count].value = line.substr(colon + 1).trim();
+      ++this->count;
+    }
+  }
+}
+
+/**
+ * @brief Received
+ *
+ * Accounts for data that was read into the space returned by space(...) and
+ * continues searching for the end of the request headers
+ *
+ * @param  length  The number of bytes that were read
+ *
+ * @return         true if the request headers are complete, otherwise false
+ */
+bool Request::received(size_t length) {
+  if (this->complete() == false) {
+    this->length += length;
+    this->scan();
+    if (this->complete())
+      this->parse();
+  }
+  return this->complete();
+}
+
+/**
+ * @brief Scan
+ *
+ * Searches the unscanned portion of the buffer for an empty line
+ */
+void Request::scan() {
+  const char* data   = this->buffer;
+  size_t      length = this->length;
+  while (this->scanned < length) {
+    const char* eol = static_cast<const char*>(memchr(data + this->scanned,
+      '\n', length - this->scanned));
+    if (eol == nullptr) {
+      this->scanned = length;
+      break;
+    }
+    size_t next = static_cast<size_t>(eol - data) + 1;
+    // Wait for more data if the line ending is the last byte received (or is
+    // followed only by a carriage return)
+    if (next == length || (next + 1 == length && data[next] == '\r')) {
+      this->scanned = next - 1;
+      break;
+    }
+    if (data[next] == '\n') {
+      this->end = next + 1;
+      break;
+    }
+    if (data[next] == '\r' && data[next + 1] == '\n') {
+      this->end = next + 2;
+      break;
+    }
+    this->scanned = next;
+  }
+}
+
+/**
+ * @brief Space
+ *
+ * Fetches the unused part of the receive buffer so that data can be read from
+ * the client directly into it, taking a buffer from the pool if none is held
+ *
+ * @param[out]  length  The number of bytes that may be written
+ *
+ * @return              A pointer to the unused part of the receive buffer
+ */
+char* Request::space(size_t& length) {
+  if (this->buffer == nullptr)
+    this->buffer = this->pool.acquire();
+  length = MAXHEADERS - this->length;
+  return this->buffer + this->length;
+}
@@ -0,0 +1,409 @@
+/**
+ * @file  Response.cpp
+ * @brief Response
+ *
+ * Class implementation for Response
+ *
+ * A Response describes everything that must be sent to answer a request: a
+ * small per-response prefix (rendered only when the status line depends on the
+ * request, such as for partial content), pre-rendered header blocks and body
+ * data that are borrowed from the FileCache entry, and a region of the file
+ * that should be sent using `sendfile64`
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
+#include "include/FileCache.hpp"
+#include "include/Request.hpp"
+#include "include/Response.hpp"
+#include "include/View.hpp"
+#include "include/slwhttp.hpp"
+
+/**
+ * @brief Accepts
+ *
+ * Determines if the value of an Accept-Encoding header allows the given
+ * content-coding as described in RFC 7231 § 5.3.4, where an explicit entry for
+ * the coding takes precedence over a wildcard and a qvalue of zero forbids it
+ *
+ * @param  list    The value of the Accept-Encoding header
+ * @param  coding  The lowercase name of the content-coding
+ *
+ * @return         true if the coding is acceptable, otherwise false
+ */
+static bool accepts(View list, const char* coding) {
+  int    wildcard = -1;
+  size_t start    = 0;
+  while (start < list.length) {
+    size_t stop = list.find(',', start);
+    if (stop == View::npos)
+      stop = list.length;
+    View item = list.substr(start, stop - start);
+    start = stop + 1;
+    // Separate the name of the coding from its parameters
+    size_t semicolon = item.find(';');
+    View   name      = item.substr(0, semicolon).trim();
+    bool   allowed   = true;
+    if (semicolon != View::npos) {
+      View parameter = item.substr(semicolon + 1).trim();
+      if (parameter.length >= 2 && parameter.substr(0, 2).iequals("q=")) {
+        // A qvalue is zero unless any of its digits are non-zero
+        allowed = false;
+        for (size_t i = 2; i < parameter.length; ++i)
+          if (parameter.data[i] >= '1' && parameter.data[i] <= '9')
+            allowed = true;
+      }
+    }
+    if (name.iequals(coding))
+      return allowed;
+    if (name.iequals("*"))
+      wildcard = allowed;
+  }
+  return wildcard > 0;
+}
+
+/**
+ * @brief ETag Matches
+ *
+ * Determines if a list of entity-tags from an If-None-Match header contains the
+ * given entity-tag using the weak comparison described in RFC 7232 § 2.3.2
+ *
+ * @param  list  The value of the If-None-Match header
+ * @param  etag  The (strong) entity-tag of the file
+ *
+ * @return       true if any entity-tag in the list matches, otherwise false
+ */
+static bool etag_matches(View list, const std::string& etag) {
+  size_t start = 0;
+  while (start < list.length) {
+    size_t stop = list.find(',', start);
+    if (stop == View::npos)
+      stop = list.length;
+    // Trim surrounding whitespace and any weakness indicator
+    View tag = list.substr(start, stop - start).trim();
+    start = stop + 1;
+    if (tag.equals(View{"*", 1}))
+      return true;
+    if (tag.length > 2 && tag.data[0] == 'W' && tag.data[1] == '/')
+      tag = tag.substr(2);
+    if (tag.equals(etag))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Parse Date
+ *
+ * Parses an IMF-fixdate as described in RFC 7231 § 7.1.1.1
+ *
+ * @param[in]   value  The formatted date
+ * @param[out]  time   The number of seconds since the epoch
+ *
+ * @return             true if the date was valid, otherwise false
+ */
+static bool parse_date(View value, time_t& time) {
+  // Copy the date so that it is terminated for strptime(...)
+  char date[64] = {};
+  if (value.length >= sizeof(date))
+    return false;
+  memcpy(date, value.data, value.length);
+  struct tm tm{};
+  const char* end = strptime(date, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  if (end == nullptr || *end != '\0')
+    return false;
+  time = timegm(&tm);
+  return time != static_cast<time_t>(-1);
+}
+
+/**
+ * @brief Not Modified
+ *
+ * Evaluates the If-None-Match and If-Modified-Since preconditions of a request
+ * as described in RFC 7232 § 6, giving precedence to If-None-Match
+ *
+ * @param  file     An open file from the FileCache
+ * @param  request  The completed request
+ *
+ * @return          true if the client's copy of the file is current, otherwise
+ *                  false
+ */
+static bool not_modified(const FileCache::Entry& file, const Request& request) {
+  View if_none_match = request.header("if-none-match");
+  if (if_none_match.empty() == false)
+    return etag_matches(if_none_match, file.etag);
+  View if_modified_since = request.header("if-modified-since");
+  if (if_modified_since.empty())
+    return false;
+  if (if_modified_since.equals(file.last_modified))
+    return true;
+  time_t since = 0;
+  return parse_date(if_modified_since, since) && file.mtime.tv_sec <= since;
+}
+
+/**
+ * @brief Parse Number
+ *
+ * Parses an unsigned decimal number from a range specifier
+ *
+ * @param[in]   str     The input string
+ * @param[in]   length  The number of characters to parse
+ * @param[out]  number  The parsed number
+ *
+ * @return              true if the input was a valid number, otherwise false
+ */
+static bool parse_number(const char* str, size_t length, int64_t& number) {
+  if (length == 0 || length > 18)
+    return false;
+  number = 0;
+  for (size_t i = 0; i < length; ++i) {
+    if (!isdigit(static_cast<unsigned char>(str[i])))
+      return false;
+    number = number * 10 + (str[i] - '0');
+  }
+  return true;
+}
+
+/**
+ * @brief Parse Range
+ *
+ * Parses a single byte range from the value of a Range header as described in
+ * RFC 7233 § 2.1, clamping it to the size of the file
+ *
+ * Requests for multiple ranges (and syntactically invalid requests) are ignored
+ * so that the whole file is sent instead, as permitted by RFC 7233 § 3.1
+ *
+ * @param[in]   value  The value of the Range header
+ * @param[in]   size   The size of the file
+ * @param[out]  first  The offset of the first byte of the range
+ * @param[out]  last   The offset of the last byte of the range
+ *
+ * @return             1 if the range is satisfiable, -1 if it is not, or 0 if
+ *                     the whole file should be sent
+ */
+static int parse_range(View value, int64_t size, int64_t& first,
+    int64_t& last) {
+  const size_t unit = sizeof("bytes=") - 1;
+  if (value.length <= unit || !value.substr(0, unit).iequals("bytes=") ||
+      value.find(',') != View::npos)
+    return 0;
+  const char* spec = value.data + unit;
+  size_t      len  = value.length - unit;
+  const char* sep  = static_cast<const char*>(memchr(spec, '-', len));
+  if (sep == nullptr)
+    return 0;
+  size_t      dash = static_cast<size_t>(sep - spec);
+  if (dash == 0) {
+    // A suffix range requests the last N bytes of the file
+    int64_t suffix = 0;
+    if (!parse_number(spec + 1, len - 1, suffix))
+      return 0;
+    if (suffix == 0 || size == 0)
+      return -1;
+    first = (suffix < size ? size - suffix : 0);
+    last  = size - 1;
+    return 1;
+  }
+  if (!parse_number(spec, dash, first))
+    return 0;
+  last = size - 1;
+  if (dash + 1 < len) {
+    int64_t end = 0;
+    if (!parse_number(spec + dash + 1, len - dash - 1, end) || end < first)
+      return 0;
+    if (end < last)
+      last = end;
+  }
+  return (first < size ? 1 : -1);
+}
+
+/**
+ * @brief Buffers
+ *
+ * Fills an array of at least RESPONSEBUFS buffers with the parts of the
+ * response that have not yet been sent, excluding the region of the file that
+ * should be sent using `sendfile64`
+ *
+ * @param  iov  The buffers to fill
+ *
+ * @return      The number of buffers that were filled
+ */
+int Response::buffers(struct iovec* iov) const {
+  struct iovec parts[RESPONSEBUFS] = {
+    {const_cast<char*>(this->prefix), this->prefix_length},
+    {nullptr, 0},
+    {nullptr, 0},
+    {const_cast<char*>(this->body), this->body_length}
+  };
+  if (this->header != nullptr)
+    parts[1] = {const_cast<char*>(this->header->data()),
+      this->header->length()};
+  if (this->header_end != nullptr)
+    parts[2] = {const_cast<char*>(this->header_end->data()),
+      this->header_end->length()};
+  // Skip the parts that were already sent (and any empty parts)
+  size_t skip  = this->sent;
+  int    count = 0;
+  for (const struct iovec& part : parts) {
+    if (skip >= part.iov_len) {
+      skip -= part.iov_len;
+      continue;
+    }
+    iov[count].iov_base = static_cast<char*>(part.iov_base) + skip;
+    iov[count].iov_len  = part.iov_len - skip;
+    skip = 0;
+    ++count;
+  }
+  return count;
+}
+
+/**
+ * @brief Bytes
+ *
+ * Determines the size of the body of the response
+ *
+ * @return  The number of bytes that follow the response header
+ */
+int64_t Response::bytes() const {
+  return this->content;
+}
+
+/**
+ * @brief Denied
+ *
+ * Builds a response to a request for a path that can't be served
+ *
+ * @param  keep_alive  Whether or not the connection will persist afterwards
+ *
+ * @return             A 403 response
+ */
+Response Response::denied(bool keep_alive) {
+  Response response{};
+  response.status = 403;
+  response.header = &access_denied_response(keep_alive);
+  // The message follows the empty line that ends the pre-rendered header
+  response.content = static_cast<int64_t>(response.header->length() -
+    (response.header->find("\r\n\r\n") + 4));
+  return response;
+}
+
+/**
+ * @brief More
+ *
+ * Determines if a region of the file should be sent using `sendfile64` after
+ * the buffers of the response
+ *
+ * @return  true if file data follows the buffers, otherwise false
+ */
+bool Response::more() const {
+  return this->length > 0;
+}
+
+/**
+ * @brief Serve
+ *
+ * Builds a response that sends the given file (or the part of it requested
+ * using a Range header) to the client, or tells the client that its cached copy
+ * of the file is still current
+ *
+ * If the file has precompressed sidecars, the first one allowed by the
+ * Accept-Encoding header of the request is sent in its place
+ *
+ * A Range header is only honored if an accompanying If-Range header matches the
+ * current entity-tag or Last-Modified date of the file
+ *
+ * @param  file        An open file from the FileCache
+ * @param  request     The completed request
+ * @param  keep_alive  Whether or not the connection will persist afterwards
+ *
+ * @return             A 200, 206, 304 or 416 response
+ */
+Response Response::serve(std::shared_ptr<const FileCache::Entry> file,
+    const Request& request, bool keep_alive) {
+  // Prefer a precompressed sidecar of the file if the client accepts it
+  if (file->brotli || file->gzip) {
+    View encodings = request.header("accept-encoding");
+    if (file->brotli && accepts(encodings, "br"))
+      file = file->brotli;
+    else if (file->gzip && accepts(encodings, "gzip"))
+      file = file->gzip;
+  }
+  Response response{};
+  response.file       = file;
+  response.status     = 200;
+  response.header     = &file->header;
+  response.header_end = &::header_end(keep_alive);
+  // Answer revalidations of a current copy of the file without a body
+  if (not_modified(*file, request)) {
+    response.status = 304;
+    response.header = &file->not_modified;
+    return response;
+  }
+  int64_t first = 0;
+  int64_t last  = file->size - 1;
+  int     range = 0;
+  View if_range = request.header("if-range");
+  if (if_range.empty() || if_range.equals(file->etag) ||
+      if_range.equals(file->last_modified))
+    range = parse_range(request.header("range"), file->size, first, last);
+  if (range < 0) {
+    response.status = 416;
+    response.header = nullptr;
+    response.prefix_length = static_cast<size_t>(snprintf(response.prefix,
+      sizeof(response.prefix), "HTTP/1.1 416 Range Not Satisfiable\r\n"
+      "Content-Length: 0\r\n"
+      "Content-Range: bytes */%lld\r\n",
+      static_cast<long long>(file->size)));
+    return response;
+  }
+  if (range > 0) {
+    response.status = 206;
+    response.header = &file->fields;
+    response.prefix_length = static_cast<size_t>(snprintf(response.prefix,
+      sizeof(response.prefix), "HTTP/1.1 206 Partial Content\r\n"
+      "Content-Length: %lld\r\n"
+      "Content-Range: bytes %lld-%lld/%lld\r\n",
+      static_cast<long long>(last - first + 1),
+      static_cast<long long>(first), static_cast<long long>(last),
+      static_cast<long long>(file->size)));
+  }
+  // Send files held in memory along with their header
+  if (file->inlined == true) {
+    response.body        = file->content.data() + first;
+    response.body_length = static_cast<size_t>(last - first + 1);
+  }
+  else {
+    response.offset = first;
+    response.length = last - first + 1;
+  }
+  response.content = last - first + 1;
+  return response;
+}
+
+/**
+ * @brief Unavailable
+ *
+ * Builds a response to a request that is turned away under load, after which
+ * the connection is closed
+ *
+ * @return  A 503 response
+ */
+Response Response::unavailable() {
+  Response response{};
+  response.status = 503;
+  response.header = &unavailable_response();
+  // The message follows the empty line that ends the pre-rendered header
+  response.content = static_cast<int64_t>(response.header->length() -
+    (response.header->find("\r\n\r\n") + 4));
+  return response;
+}
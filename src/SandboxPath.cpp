@@ -4,17 +4,38 @@
  *
  * Class implementation for SandboxPath
  *
+ * Where the kernel supports `openat2`, files are opened relative to a
+ * descriptor of the jail that is held open, with RESOLVE_BENEATH making the
+ * kernel refuse any path (including through `..` or symbolic links) that would
+ * leave it.  Resolving, sandboxing and opening the file is then a single system
+ * call with no window between checking the path and opening it
+ *
+ * Opened files are identified by their path relative to the jail, which is
+ * checked again with `fstatat` on the jail's descriptor so that no absolute
+ * path is ever trusted after the file was opened
+ *
  * @author     Clay Freeman
  * @date       December 1, 2015
  */
 
+#include <cerrno>
+#include <fcntl.h>
 #include <stdexcept>
 #include <string>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "ext/File/File.hpp"
 #include "include/SandboxPath.hpp"
 
+#ifdef HAVE_LINUX_OPENAT2_H
+#include <linux/openat2.h>
+#endif
+
 // Initialize static members
+bool        SandboxPath::beneath = true;
 std::string SandboxPath::jail{};
+int         SandboxPath::jailfd  = -1;
 
 /**
  * @brief SandboxPath Constructor
@@ -52,21 +73,107 @@ const std::string& SandboxPath::get() const {
   return this->rpath;
 }
 
+/**
+ * @brief Open
+ *
+ * Opens a file for reading relative to the jail, letting the kernel resolve
+ * the path and refuse it if it would leave the jail
+ *
+ * @param[in]   path      The absolute (but not yet sandboxed) path
+ * @param[out]  relative  The path of the opened file relative to the jail
+ *
+ * @return                The file descriptor, or -1 if the kernel can't open
+ *                        files beneath a directory (so a SandboxPath should
+ *                        be used instead)
+ */
+int SandboxPath::open(const std::string& path, std::string& relative) {
+#ifdef HAVE_LINUX_OPENAT2_H
+  if (SandboxPath::beneath == false || SandboxPath::jailfd < 0)
+    return -1;
+  // Determine the path relative to the jail
+  const std::string& jail = SandboxPath::jail;
+  if (path.compare(0, jail.length(), jail) != 0 ||
+      path.length() <= jail.length() || path[jail.length()] != '/')
+    throw std::runtime_error{"\"" + path + "\" is outside of the jail"};
+  size_t start = path.find_first_not_of('/', jail.length());
+  if (start == std::string::npos)
+    throw std::runtime_error{"\"" + path + "\" is not a readable file"};
+  struct open_how how{};
+  how.flags   = O_RDONLY | O_CLOEXEC;
+  how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+  int fd = static_cast<int>(syscall(SYS_openat2, SandboxPath::jailfd,
+    path.c_str() + start, &how, sizeof(how)));
+  if (fd < 0) {
+    // Fall back to resolving paths in userspace on kernels before 5.6 (or
+    // where seccomp filters deny the system call)
+    if (errno == ENOSYS || errno == EPERM) {
+      SandboxPath::beneath = false;
+      return -1;
+    }
+    throw std::runtime_error{"openat2(\"" + path + "\") failed"};
+  }
+  relative.assign(path, start, std::string::npos);
+  return fd;
+#else
+  (void)path;
+  (void)relative;
+  return -1;
+#endif
+}
+
+/**
+ * @brief Relative
+ *
+ * Determines the path of a file within the jail relative to the jail
+ *
+ * @param  rpath  The real path of the file (which must be within the jail)
+ *
+ * @return        The path relative to the jail
+ */
+std::string SandboxPath::relative(const std::string& rpath) {
+  if (SandboxPath::checkJail(rpath) == false)
+    throw std::runtime_error{"checkJail(\"" + rpath + "\") = false"};
+  return rpath.substr(SandboxPath::jail.length() + 1);
+}
+
 /**
  * @brief Set Jail
  *
- * Sets the jail for all SandboxPath objects
+ * Sets the jail for all SandboxPath objects, holding a descriptor of it open
+ * so that files can be opened relative to it
  *
  * @param  path  The input path
  *
  * @return       true if valid, otherwise false
  */
 bool SandboxPath::setJail(const std::string& path) {
-  if (SandboxPath::jail.length() == 0)
+  if (SandboxPath::jail.length() == 0) {
     SandboxPath::jail = File::realPath(path);
+    if (SandboxPath::jail.length() > 0)
+      SandboxPath::jailfd = ::open(SandboxPath::jail.c_str(), O_PATH |
+        O_DIRECTORY | O_CLOEXEC);
+  }
   return SandboxPath::jail.length() > 0;
 }
 
+/**
+ * @brief Stat
+ *
+ * Fetches the status of a file relative to the jail (without following a
+ * symbolic link at the end of the path)
+ *
+ * @param[in]   relative  The path of the file relative to the jail
+ * @param[out]  info      The status of the file
+ *
+ * @return                true if the status was fetched, otherwise false
+ */
+bool SandboxPath::stat(const std::string& relative, struct stat& info) {
+  if (SandboxPath::jailfd >= 0)
+    return fstatat(SandboxPath::jailfd, relative.c_str(), &info,
+      AT_SYMLINK_NOFOLLOW) == 0;
+  return lstat((SandboxPath::jail + "/" + relative).c_str(), &info) == 0;
+}
+
 /**
  * @brief Check Jail
  *
@@ -76,15 +183,10 @@ bool SandboxPath::setJail(const std::string& path) {
  *
  * @return       true if valid, otherwise false
  */
-bool SandboxPath::checkJail(std::string path) {
-  bool valid = false;
-  // Verify length constraints
-  if (path.length() > SandboxPath::jail.length() + 1) {
-    // Trim the string to the valid length
-    path = path.substr(0, SandboxPath::jail.length() + 1);
-    // Verify that the most significant path components match the sandbox
-    if (path == SandboxPath::jail + "/")
-      valid = true;
-  }
-  return valid;
+bool SandboxPath::checkJail(const std::string& path) {
+  const std::string& jail = SandboxPath::jail;
+  // Verify length constraints, then that the most significant path components
+  // match the sandbox (without copying either string)
+  return path.length() > jail.length() + 1 &&
+    path.compare(0, jail.length(), jail) == 0 && path[jail.length()] == '/';
 }
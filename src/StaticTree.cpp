@@ -0,0 +1,301 @@
+/**
+ * @file  StaticTree.cpp
+ * @brief StaticTree
+ *
+ * Class implementation for StaticTree
+ *
+ * A StaticTree is an index of every regular file beneath the document root,
+ * built by scanning the tree once at startup, that maps each file's path
+ * (relative to the document root) to its resolved path.  Looking up a request
+ * path then costs a single hash probe instead of resolving it component by
+ * component through SandboxPath, and since only indexed files can be served,
+ * nothing outside of the jail can be reached
+ *
+ * Symbolic links to regular files are indexed under their own name if they
+ * resolve to a file inside of the jail, but symbolic links to directories are
+ * never followed.  Every directory in the tree is watched using inotify, and
+ * the whole tree is scanned again (and the index replaced) shortly after it
+ * changes or when a reload is requested
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "ext/File/File.hpp"
+#include "include/SandboxPath.hpp"
+#include "include/StaticTree.hpp"
+#include "include/slwhttp.hpp"
+
+// The changes to a directory that make the index stale
+#define TREEEVENTS (IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVED_FROM | \
+                    IN_MOVED_TO | IN_MOVE_SELF | IN_ONLYDIR)
+// The number of milliseconds to wait before retrying a failed scan
+#define TREERETRY  1000
+// The number of milliseconds to wait for a burst of changes to settle
+#define TREESETTLE 100
+
+// Initialize static members
+std::shared_ptr<const StaticTree::Index> StaticTree::index{};
+int                                      StaticTree::inotify = -1;
+std::string                              StaticTree::root{};
+std::atomic<bool>                        StaticTree::running{false};
+int                                      StaticTree::wakeup = -1;
+
+/**
+ * @brief Build
+ *
+ * Scans the document root into the index, enabling lookups through it; the
+ * jail of SandboxPath must already be set to the same directory
+ *
+ * @param  root  The resolved path of the document root
+ */
+void StaticTree::build(const std::string& root) {
+  StaticTree::root = root;
+  int watcher = -1;
+  std::shared_ptr<const Index> index = StaticTree::scan(watcher);
+  std::atomic_store(&StaticTree::index, index);
+  StaticTree::inotify = watcher;
+  StaticTree::wakeup  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  debug("static tree indexed {} files", index->size());
+}
+
+/**
+ * @brief Enabled
+ *
+ * Determines if request paths should be looked up in the index
+ *
+ * @return  true if the index was built, otherwise false
+ */
+bool StaticTree::enabled() {
+  return StaticTree::root.length() > 0;
+}
+
+/**
+ * @brief Find
+ *
+ * Looks up an absolute (but not yet sandboxed) request path in the index,
+ * normalizing its "." and ".." components without touching the filesystem
+ *
+ * @param[in]   path   The absolute request path
+ * @param[out]  rpath  The resolved path of the file
+ *
+ * @return             true if the path refers to an indexed file, otherwise
+ *                     false
+ */
+bool StaticTree::find(const std::string& path, std::string& rpath) {
+  // Only files (not directories) beneath the document root are indexed
+  const std::string& root = StaticTree::root;
+  if (path.length() <= root.length() + 1 || path.back() == '/' ||
+      path.compare(0, root.length(), root) != 0 || path[root.length()] != '/')
+    return false;
+  std::string key{};
+  key.reserve(path.length() - root.length());
+  size_t position = root.length();
+  while (position < path.length()) {
+    if (path[position] == '/') {
+      ++position;
+      continue;
+    }
+    size_t end = path.find('/', position);
+    if (end == std::string::npos)
+      end = path.length();
+    size_t length = end - position;
+    if (length == 2 && path.compare(position, 2, "..") == 0) {
+      // Never climb above the document root
+      if (key.empty())
+        return false;
+      size_t slash = key.rfind('/');
+      key.erase(slash == std::string::npos ? 0 : slash);
+    }
+    else if (length != 1 || path[position] != '.') {
+      if (!key.empty())
+        key.push_back('/');
+      key.append(path, position, length);
+    }
+    position = end;
+  }
+  std::shared_ptr<const Index> index = std::atomic_load(&StaticTree::index);
+  auto it = index->find(key);
+  if (it == index->end())
+    return false;
+  rpath = it->second;
+  return true;
+}
+
+/**
+ * @brief Reload
+ *
+ * Asks the thread that keeps the index current to scan the tree again (which
+ * is only needed for changes that inotify can't see, such as those made on
+ * another host sharing the tree)
+ */
+void StaticTree::reload() {
+  uint64_t count = 1;
+  if (StaticTree::running.load() == true &&
+      write(StaticTree::wakeup, &count, sizeof(count)) != sizeof(count))
+    debug_error("failed to request a static tree reload");
+}
+
+/**
+ * @brief Run
+ *
+ * Scans the tree again whenever it changes (once the changes have settled) or
+ * a reload is requested
+ */
+void StaticTree::run() {
+  alignas(struct inotify_event) char buffer[4096];
+  bool stale = false;
+  while (true) {
+    // Wait for the tree to change or a reload to be requested (or for the time
+    // to retry a failed scan)
+    struct pollfd events[] = {
+      {StaticTree::inotify, POLLIN, 0},
+      {StaticTree::wakeup,  POLLIN, 0}
+    };
+    int ready = poll(events, 2, (stale == true ? TREERETRY : -1));
+    if (ready < 0 || (ready == 0 && stale == false))
+      continue;
+    // Discard the events of each burst of changes, since the whole tree will
+    // be scanned again regardless
+    while (ready > 0) {
+      for (const auto& event : events)
+        while (event.fd >= 0 && read(event.fd, buffer, sizeof(buffer)) > 0);
+      ready = poll(events, 2, TREESETTLE);
+    }
+    try {
+      int watcher = -1;
+      std::shared_ptr<const Index> index = StaticTree::scan(watcher);
+      std::atomic_store(&StaticTree::index, index);
+      if (watcher >= 0) {
+        StaticTree::inotify = watcher;
+        if (events[0].fd >= 0)
+          close(events[0].fd);
+      }
+      stale = false;
+      debug("static tree indexed {} files", index->size());
+    } catch (const std::exception& e) {
+      // Keep serving from the last index until a scan succeeds
+      debug("{}", e.what());
+      stale = true;
+    }
+  }
+}
+
+/**
+ * @brief Scan
+ *
+ * Builds a new index of the document root, watching each of its directories
+ * for changes
+ *
+ * @param[out]  watcher  The inotify descriptor watching the tree, or -1 if it
+ *                       couldn't be created
+ *
+ * @return               The new index
+ */
+std::shared_ptr<const StaticTree::Index> StaticTree::scan(int& watcher) {
+  watcher = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watcher < 0)
+    debug_error("failed to watch the static tree for changes");
+  int dirfd = ::open(StaticTree::root.c_str(), O_RDONLY | O_DIRECTORY |
+    O_CLOEXEC);
+  std::shared_ptr<Index> index = std::make_shared<Index>();
+  try {
+    if (dirfd < 0)
+      throw std::runtime_error{"failed to open \"" + StaticTree::root + "\""};
+    StaticTree::scanDirectory(*index, watcher, dirfd, "");
+  } catch (const std::exception& e) {
+    if (watcher >= 0)
+      close(watcher);
+    watcher = -1;
+    throw;
+  }
+  return index;
+}
+
+/**
+ * @brief Scan Directory
+ *
+ * Adds every regular file beneath a directory to the index, taking ownership
+ * of the directory's descriptor
+ *
+ * @param  index     The index
+ * @param  watcher   The inotify descriptor watching the tree, or -1
+ * @param  dirfd     A descriptor of the directory
+ * @param  relative  The path of the directory relative to the document root
+ */
+void StaticTree::scanDirectory(Index& index, int watcher, int dirfd,
+    const std::string& relative) {
+  const std::string path = StaticTree::root +
+    (relative.empty() ? "" : "/" + relative);
+  // Watch the directory before listing it so that no change goes unnoticed
+  if (watcher >= 0 && inotify_add_watch(watcher, path.c_str(), TREEEVENTS) < 0)
+    debug_error("failed to watch \"{}\" for changes", path);
+  DIR* dir = fdopendir(dirfd);
+  if (dir == nullptr) {
+    close(dirfd);
+    throw std::runtime_error{"failed to list \"" + path + "\""};
+  }
+  std::vector<std::string> directories{};
+  while (struct dirent* entry = readdir(dir)) {
+    const std::string name{entry->d_name};
+    if (name == "." || name == "..")
+      continue;
+    const std::string key = (relative.empty() ? name : relative + "/" + name);
+    struct stat info;
+    if (fstatat(dirfd, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) != 0)
+      continue;
+    if (S_ISDIR(info.st_mode))
+      directories.push_back(name);
+    else if (S_ISREG(info.st_mode))
+      index.emplace(key, path + "/" + name);
+    else if (S_ISLNK(info.st_mode)) {
+      // Index links to regular files that resolve to somewhere in the jail
+      std::string rpath = File::realPath(path + "/" + name);
+      if (rpath.length() > 0 && SandboxPath::checkJail(rpath) &&
+          stat(rpath.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+        index.emplace(key, rpath);
+    }
+  }
+  try {
+    for (const auto& name : directories) {
+      int child = openat(dirfd, name.c_str(), O_RDONLY | O_DIRECTORY |
+        O_NOFOLLOW | O_CLOEXEC);
+      if (child >= 0)
+        StaticTree::scanDirectory(index, watcher, child, (relative.empty() ?
+          name : relative + "/" + name));
+      else
+        debug_error("failed to open \"{}/{}\"", path, name);
+    }
+  } catch (const std::exception& e) {
+    closedir(dir);
+    throw;
+  }
+  closedir(dir);
+}
+
+/**
+ * @brief Start
+ *
+ * Starts the thread that keeps the index current (which must happen after the
+ * process has daemonized, since threads don't survive `fork`)
+ */
+void StaticTree::start() {
+  bool running = false;
+  if ((StaticTree::inotify >= 0 || StaticTree::wakeup >= 0) &&
+      StaticTree::running.compare_exchange_strong(running, true))
+    std::thread{StaticTree::run}.detach();
+}
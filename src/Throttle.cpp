@@ -0,0 +1,242 @@
+/**
+ * @file  Throttle.cpp
+ * @brief Throttle
+ *
+ * Class implementation for Throttle
+ *
+ * A Throttle limits how quickly file content is sent to a single client, and
+ * (through a bucket shared by every Throttle) to all clients together, using a
+ * token bucket for each limit that holds up to a tenth of a second's worth of
+ * bytes (but at least THROTTLEMIN bytes).  Each chunk of a file must be
+ * granted by both buckets before it is sent, and any part of the grant that the
+ * socket didn't accept is refunded
+ *
+ * So that the shared limit is divided evenly rather than going to whichever
+ * client asks first, each client that is sending a file is also limited to an
+ * equal share of it
+ *
+ * Grants are never smaller than THROTTLEMIN bytes (unless less was wanted), so
+ * a TLS record that OpenSSL must retry is always granted again in full
+ *
+ * A Throttle without any limit grants everything without taking a lock
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include "include/Throttle.hpp"
+
+// The number of times per second that each bucket can be emptied by a burst
+#define THROTTLEHZ    10
+// The smallest number of bytes granted at once (unless less was wanted)
+#define THROTTLEMIN   16384
+
+// Initialize static members
+size_t              Throttle::connection_rate = 0;
+Throttle::Bucket    Throttle::total{};
+std::atomic<size_t> Throttle::transfers{0};
+
+/**
+ * @brief Throttle Constructor
+ *
+ * Creates a throttle limited to the configured rate for each connection
+ */
+Throttle::Throttle() {
+  this->own.rate   = Throttle::connection_rate;
+  this->own.last   = std::chrono::steady_clock::now();
+  this->own.tokens = static_cast<double>(this->own.burst());
+}
+
+/**
+ * @brief Throttle Destructor
+ *
+ * Stops counting the throttle's transfer (if any) towards the shared limit
+ */
+Throttle::~Throttle() {
+  this->finish();
+}
+
+/**
+ * @brief Burst
+ *
+ * Determines the number of bytes that the bucket can hold
+ *
+ * @return  The capacity of the bucket in bytes
+ */
+size_t Throttle::Bucket::burst() const {
+  return std::max<size_t>(this->rate / THROTTLEHZ, THROTTLEMIN);
+}
+
+/**
+ * @brief Refill
+ *
+ * Adds the tokens earned since the bucket was last refilled (the caller must
+ * hold the bucket's lock)
+ *
+ * @param  now  The current time
+ */
+void Throttle::Bucket::refill(std::chrono::steady_clock::time_point now) {
+  if (now > this->last) {
+    std::chrono::duration<double> elapsed = now - this->last;
+    this->tokens = std::min(static_cast<double>(this->burst()), this->tokens +
+      elapsed.count() * static_cast<double>(this->rate));
+    this->last   = now;
+  }
+}
+
+/**
+ * @brief Ready
+ *
+ * Determines when the bucket will next hold enough tokens to grant a chunk
+ *
+ * @param  now  The current time
+ *
+ * @return      The time at which tokens can next be taken
+ */
+std::chrono::steady_clock::time_point Throttle::Bucket::ready(
+    std::chrono::steady_clock::time_point now) {
+  if (this->rate == 0)
+    return now;
+  std::unique_lock<std::mutex> lock{this->mutex};
+  this->refill(now);
+  double needed = THROTTLEMIN - this->tokens;
+  if (needed <= 0)
+    return now;
+  return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    std::chrono::duration<double>{needed / static_cast<double>(this->rate)});
+}
+
+/**
+ * @brief Refund
+ *
+ * Returns tokens that were taken but not used
+ *
+ * @param  bytes  The number of bytes that weren't sent
+ */
+void Throttle::Bucket::refund(size_t bytes) {
+  if (this->rate == 0 || bytes == 0)
+    return;
+  std::unique_lock<std::mutex> lock{this->mutex};
+  this->tokens = std::min(static_cast<double>(this->burst()), this->tokens +
+    static_cast<double>(bytes));
+}
+
+/**
+ * @brief Take
+ *
+ * Takes up to the given number of tokens from the bucket, taking none unless
+ * at least a chunk's worth (or the number wanted) is available
+ *
+ * @param  wanted  The number of bytes that would be sent
+ * @param  now     The current time
+ *
+ * @return         The number of bytes that may be sent
+ */
+size_t Throttle::Bucket::take(size_t wanted,
+    std::chrono::steady_clock::time_point now) {
+  if (this->rate == 0)
+    return wanted;
+  std::unique_lock<std::mutex> lock{this->mutex};
+  this->refill(now);
+  size_t available = (this->tokens > 0 ? static_cast<size_t>(this->tokens) :
+    0);
+  if (available < std::min<size_t>(wanted, THROTTLEMIN))
+    return 0;
+  size_t granted = std::min(wanted, available);
+  this->tokens  -= static_cast<double>(granted);
+  return granted;
+}
+
+/**
+ * @brief Finish
+ *
+ * Marks the end of a transfer, so that it no longer takes a share of the limit
+ * shared by all connections
+ */
+void Throttle::finish() {
+  if (this->active == true) {
+    this->active = false;
+    Throttle::transfers.fetch_sub(1);
+  }
+}
+
+/**
+ * @brief Grant
+ *
+ * Determines how much of a file may be sent right now under both the
+ * connection's limit and the limit shared by all connections
+ *
+ * @param  wanted  The number of bytes that would be sent
+ *
+ * @return         The number of bytes that may be sent (zero if the caller
+ *                 must wait until `resume`)
+ */
+size_t Throttle::grant(size_t wanted) {
+  if (Throttle::connection_rate == 0 && Throttle::total.rate == 0)
+    return wanted;
+  if (this->active == false) {
+    this->active = true;
+    Throttle::transfers.fetch_add(1);
+  }
+  // Limit the connection to its share of the shared limit, if that is lower
+  this->own.rate = Throttle::connection_rate;
+  if (Throttle::total.rate > 0) {
+    size_t share = Throttle::total.rate / std::max<size_t>(1,
+      Throttle::transfers.load());
+    if (this->own.rate == 0 || share < this->own.rate)
+      this->own.rate = share;
+  }
+  auto now = std::chrono::steady_clock::now();
+  size_t granted = this->own.take(wanted, now);
+  if (granted == 0)
+    return 0;
+  size_t shared = Throttle::total.take(granted, now);
+  this->own.refund(granted - shared);
+  return shared;
+}
+
+/**
+ * @brief Refund
+ *
+ * Returns the part of a grant that the client's socket didn't accept
+ *
+ * @param  bytes  The number of granted bytes that weren't sent
+ */
+void Throttle::refund(size_t bytes) {
+  this->own.refund(bytes);
+  Throttle::total.refund(bytes);
+}
+
+/**
+ * @brief Resume
+ *
+ * Determines when the next grant can be made
+ *
+ * @return  The time at which sending may resume
+ */
+std::chrono::steady_clock::time_point Throttle::resume() {
+  auto now = std::chrono::steady_clock::now();
+  return std::max(this->own.ready(now), Throttle::total.ready(now));
+}
+
+/**
+ * @brief Set Rates
+ *
+ * Sets the limits on how quickly file content is sent (zero disables a limit),
+ * which apply to throttles created afterwards
+ *
+ * @param  connection  The number of bytes per second sent to each client
+ * @param  total       The number of bytes per second sent to all clients
+ */
+void Throttle::setRates(size_t connection, size_t total) {
+  Throttle::connection_rate = connection;
+  std::unique_lock<std::mutex> lock{Throttle::total.mutex};
+  Throttle::total.rate   = total;
+  Throttle::total.last   = std::chrono::steady_clock::now();
+  Throttle::total.tokens = static_cast<double>(Throttle::total.burst());
+}
@@ -0,0 +1,357 @@
+/**
+ * @file  Tls.cpp
+ * @brief Tls
+ *
+ * Class implementation for Tls
+ *
+ * Tls terminates TLS for every client using OpenSSL for the handshake and
+ * kernel TLS (kTLS) for the records that follow: once the handshake completes,
+ * OpenSSL hands the session keys to the kernel, after which the socket encrypts
+ * everything written to it, so response headers are still sent with `sendmsg`
+ * and files are still sent with `sendfile64` without being copied into
+ * userspace.  Where the kernel can't take over a direction (the `tls` module
+ * isn't loaded, or it doesn't support the negotiated cipher), that direction
+ * is handled by OpenSSL instead, reading files in record-sized chunks
+ *
+ * Only ciphers that the kernel can take over are offered.  Sessions are resumed
+ * from stateless tickets (TLS 1.3) or from the server's session cache (TLS
+ * 1.2) to keep the cost of reconnecting clients down
+ *
+ * Every function accepts a null session, in which case the socket is used as
+ * plain HTTP
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "include/Tls.hpp"
+#include "include/slwhttp.hpp"
+
+#ifdef ENABLE_TLS
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+// Initialize static members
+static SSL_CTX* context = nullptr;
+
+/**
+ * @brief Fail
+ *
+ * Translates the result of an OpenSSL I/O function into the result of the
+ * equivalent system call
+ *
+ * @param  ssl     The session
+ * @param  result  The result of the OpenSSL function
+ *
+ * @return         0 if the peer closed the session, otherwise -1 (with
+ *                 errno set to EAGAIN if the call should be retried)
+ */
+static ssize_t fail(SSL* ssl, int result) {
+  int error = SSL_get_error(ssl, result);
+  ERR_clear_error();
+  switch (error) {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_WRITE:
+      errno = EAGAIN;
+      return -1;
+    case SSL_ERROR_ZERO_RETURN:
+      return 0;
+    case SSL_ERROR_SYSCALL:
+      return (errno == 0 ? 0 : -1);
+    default:
+      errno = EIO;
+      return -1;
+  }
+}
+#endif
+
+/**
+ * @brief Accept
+ *
+ * Creates a server-side session for a newly accepted client
+ *
+ * @param  fd  The file descriptor of the client
+ *
+ * @return     The session, or nullptr if TLS is disabled (or on failure)
+ */
+struct ssl_st* Tls::accept(int fd) {
+#ifdef ENABLE_TLS
+  if (context == nullptr)
+    return nullptr;
+  SSL* ssl = SSL_new(context);
+  if (ssl != nullptr && SSL_set_fd(ssl, fd) != 1) {
+    SSL_free(ssl);
+    ssl = nullptr;
+  }
+  if (ssl != nullptr)
+    SSL_set_accept_state(ssl);
+  return ssl;
+#else
+  (void)fd;
+  return nullptr;
+#endif
+}
+
+/**
+ * @brief Configure
+ *
+ * Enables TLS for every client using the given certificate chain and private
+ * key (which must be loaded before privileges are dropped)
+ *
+ * @param  certificate  The path of the PEM certificate chain
+ * @param  key          The path of the PEM private key
+ */
+void Tls::configure(const std::string& certificate, const std::string& key) {
+#ifdef ENABLE_TLS
+  SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+  if (ctx == nullptr)
+    throw std::runtime_error{"failed to create TLS context"};
+  SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+  // Let OpenSSL hand the session keys to the kernel after the handshake
+  SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS | SSL_OP_NO_RENEGOTIATION |
+    SSL_OP_CIPHER_SERVER_PREFERENCE);
+  SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+    SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_RELEASE_BUFFERS);
+  // Only offer the ciphers supported by kTLS
+  SSL_CTX_set_cipher_list(ctx, "ECDHE+AESGCM:ECDHE+CHACHA20");
+  SSL_CTX_set_ciphersuites(ctx, "TLS_AES_128_GCM_SHA256:"
+    "TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256");
+  // Resume sessions using tickets or the server's session cache
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_set_session_id_context(ctx, reinterpret_cast<const unsigned char*>(
+    PACKAGE_NAME), sizeof(PACKAGE_NAME) - 1);
+  SSL_CTX_sess_set_cache_size(ctx, TLSSESSIONS);
+  SSL_CTX_set_num_tickets(ctx, 1);
+  if (SSL_CTX_use_certificate_chain_file(ctx, certificate.c_str()) != 1 ||
+      SSL_CTX_use_PrivateKey_file(ctx, key.c_str(), SSL_FILETYPE_PEM) != 1 ||
+      SSL_CTX_check_private_key(ctx) != 1) {
+    SSL_CTX_free(ctx);
+    ERR_clear_error();
+    throw std::runtime_error{"failed to load TLS certificate \"" +
+      certificate + "\" with key \"" + key + "\""};
+  }
+  context = ctx;
+#else
+  (void)certificate;
+  (void)key;
+  throw std::runtime_error{"TLS support was disabled at build time"};
+#endif
+}
+
+/**
+ * @brief Enabled
+ *
+ * Determines if clients are served using TLS
+ *
+ * @return  true if a certificate was configured, otherwise false
+ */
+bool Tls::enabled() {
+#ifdef ENABLE_TLS
+  return context != nullptr;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Handshake
+ *
+ * Advances the handshake of a session as far as its socket allows
+ *
+ * @param  ssl  The session
+ *
+ * @return      Whether the handshake is done, must wait for the socket to
+ *              become readable or writable, or has failed
+ */
+Tls::Result Tls::handshake(struct ssl_st* ssl) {
+#ifdef ENABLE_TLS
+  if (ssl == nullptr)
+    return Result::Failed;
+  int result = SSL_do_handshake(ssl);
+  if (result == 1) {
+    debug("TLS handshake done ({}{}, kTLS send: {}, receive: {})",
+      SSL_get_version(ssl), (SSL_session_reused(ssl) ? ", resumed" : ""),
+      (Tls::kernel(ssl, false) ? "yes" : "no"),
+      (Tls::kernel(ssl, true)  ? "yes" : "no"));
+    return Result::Done;
+  }
+  int error = SSL_get_error(ssl, result);
+  ERR_clear_error();
+  if (error == SSL_ERROR_WANT_READ)
+    return Result::WantRead;
+  if (error == SSL_ERROR_WANT_WRITE)
+    return Result::WantWrite;
+  return Result::Failed;
+#else
+  (void)ssl;
+  return Result::Failed;
+#endif
+}
+
+/**
+ * @brief Kernel
+ *
+ * Determines if the kernel took over one direction of a session
+ *
+ * @param  ssl      The session
+ * @param  receive  Whether to check the receiving (rather than sending) side
+ *
+ * @return          true if the socket itself handles that direction, otherwise
+ *                  false
+ */
+bool Tls::kernel(struct ssl_st* ssl, bool receive) {
+#ifdef ENABLE_TLS
+  return (receive == true ? BIO_get_ktls_recv(SSL_get_rbio(ssl)) :
+    BIO_get_ktls_send(SSL_get_wbio(ssl)));
+#else
+  (void)ssl;
+  (void)receive;
+  return true;
+#endif
+}
+
+/**
+ * @brief Pending
+ *
+ * Determines if data was already received and decrypted by OpenSSL (so that
+ * the socket won't report it as readable)
+ *
+ * @param  ssl  The session (or nullptr)
+ *
+ * @return      true if data can be read without waiting, otherwise false
+ */
+bool Tls::pending(struct ssl_st* ssl) {
+#ifdef ENABLE_TLS
+  return ssl != nullptr && SSL_pending(ssl) > 0;
+#else
+  (void)ssl;
+  return false;
+#endif
+}
+
+/**
+ * @brief Read
+ *
+ * Reads from a client with the semantics of `read`
+ *
+ * @param  ssl     The session (or nullptr)
+ * @param  fd      The file descriptor of the client
+ * @param  buffer  The buffer to read into
+ * @param  length  The size of the buffer
+ *
+ * @return         The number of bytes read, 0 if the client disconnected, or
+ *                 -1 on failure (see errno)
+ */
+ssize_t Tls::read(struct ssl_st* ssl, int fd, char* buffer, size_t length) {
+#ifdef ENABLE_TLS
+  if (ssl != nullptr && Tls::kernel(ssl, true) == false) {
+    int result = SSL_read(ssl, buffer, static_cast<int>(std::min<size_t>(
+      length, INT32_MAX)));
+    return (result > 0 ? result : fail(ssl, result));
+  }
+#else
+  (void)ssl;
+#endif
+  return ::read(fd, buffer, length);
+}
+
+/**
+ * @brief Release
+ *
+ * Notifies the client that the session is closing and frees it
+ *
+ * @param  ssl  The session (or nullptr)
+ */
+void Tls::release(struct ssl_st* ssl) {
+#ifdef ENABLE_TLS
+  if (ssl != nullptr) {
+    if (SSL_is_init_finished(ssl))
+      SSL_shutdown(ssl);
+    ERR_clear_error();
+    SSL_free(ssl);
+  }
+#else
+  (void)ssl;
+#endif
+}
+
+/**
+ * @brief Send
+ *
+ * Writes the given buffers to a client with the semantics of `sendmsg`
+ *
+ * @param  ssl     The session (or nullptr)
+ * @param  fd      The file descriptor of the client
+ * @param  iov     The buffers to write
+ * @param  iovcnt  The number of buffers
+ * @param  more    Whether or not more data will be sent immediately afterwards
+ *
+ * @return         The number of bytes written, or -1 on failure (see errno)
+ */
+ssize_t Tls::send(struct ssl_st* ssl, int fd, const struct iovec* iov,
+    int iovcnt, bool more) {
+#ifdef ENABLE_TLS
+  if (ssl != nullptr && Tls::kernel(ssl, false) == false) {
+    // Encrypt the first buffer that isn't empty as a record of its own
+    for (; iovcnt > 0 && iov->iov_len == 0; --iovcnt, ++iov);
+    if (iovcnt == 0)
+      return 0;
+    int result = SSL_write(ssl, iov->iov_base, static_cast<int>(
+      std::min<size_t>(iov->iov_len, INT32_MAX)));
+    return (result > 0 ? result : (fail(ssl, result) == 0 ? (errno = EPIPE,
+      -1) : -1));
+  }
+#else
+  (void)ssl;
+#endif
+  struct msghdr msg{};
+  msg.msg_iov    = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = static_cast<size_t>(iovcnt);
+  return sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+}
+
+/**
+ * @brief Sendfile
+ *
+ * Writes part of a file to a client with the semantics of `sendfile64`
+ *
+ * @param  ssl     The session (or nullptr)
+ * @param  out_fd  The file descriptor of the client
+ * @param  in_fd   The file descriptor of the file
+ * @param  offset  The offset of the data within the file (advanced past the
+ *                 data that was written)
+ * @param  length  The amount of data to write
+ *
+ * @return         The number of bytes written, or -1 on failure (see errno)
+ */
+ssize_t Tls::sendfile(struct ssl_st* ssl, int out_fd, int in_fd,
+    int64_t* offset, int64_t length) {
+#ifdef ENABLE_TLS
+  if (ssl != nullptr && Tls::kernel(ssl, false) == false) {
+    // Encrypt the file one record at a time (OpenSSL accepts the same data
+    // from a different buffer when a write is retried)
+    static thread_local char buffer[TLSCHUNK];
+    ssize_t data_read = pread(in_fd, buffer, static_cast<size_t>(std::min<
+      int64_t>(length, TLSCHUNK)), static_cast<off_t>(*offset));
+    if (data_read <= 0)
+      return data_read;
+    int result = SSL_write(ssl, buffer, static_cast<int>(data_read));
+    if (result <= 0)
+      return (fail(ssl, result) == 0 ? (errno = EPIPE, -1) : -1);
+    *offset += result;
+    return result;
+  }
+#else
+  (void)ssl;
+#endif
+  return sendfile64(out_fd, in_fd, offset, static_cast<size_t>(length));
+}
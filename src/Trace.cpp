@@ -0,0 +1,123 @@
+/**
+ * @file  Trace.cpp
+ * @brief Trace
+ *
+ * Class implementation for Trace
+ *
+ * A Trace follows a single request through each stage of being answered,
+ * recording how long each stage took in the metrics (see Metrics) and firing
+ * the tracing probe for it, so the same points can be watched with a tracer
+ * attached as are measured without one:
+ *
+ *   accept           (fd, clients already connected)
+ *   header_complete  (fd, nanoseconds spent reading the request headers)
+ *   resolved         (fd, nanoseconds until the path was resolved)
+ *   headers_sent     (fd, nanoseconds until the first byte was sent)
+ *   body_complete    (fd, nanoseconds until the response was sent)
+ *
+ * The probes are only compiled in when configured with --enable-probes.  The
+ * time taken by each stage is also kept until the request is logged so that
+ * one in every N requests can have it written to the access log
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "include/Metrics.hpp"
+#include "include/Trace.hpp"
+
+// Initialize static members
+std::atomic<size_t> Trace::count{0};
+size_t              Trace::every = 0;
+
+/**
+ * @brief Trace Constructor
+ *
+ * Prepares to follow the requests of a client
+ *
+ * @param  fd  The file descriptor of the associated client
+ */
+Trace::Trace(int fd): fd{fd} {
+  this->reset();
+}
+
+/**
+ * @brief Mark
+ *
+ * Records that the request has passed the given stage
+ *
+ * @param  stage    The stage
+ * @param  elapsed  The time taken to reach the stage
+ */
+void Trace::mark(Metrics::Stage stage,
+    std::chrono::steady_clock::duration elapsed) {
+  Metrics::record(stage, elapsed);
+  int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    elapsed).count();
+  switch (stage) {
+    case Metrics::HeaderRead:
+      TRACEPOINT(header_complete, this->fd, nanoseconds);
+      break;
+    case Metrics::Resolve:
+      TRACEPOINT(resolved, this->fd, nanoseconds);
+      break;
+    case Metrics::FirstByte:
+      TRACEPOINT(headers_sent, this->fd, nanoseconds);
+      break;
+    default:
+      TRACEPOINT(body_complete, this->fd, nanoseconds);
+      return;
+  }
+  this->spans[stage] = nanoseconds / 1000;
+}
+
+/**
+ * @brief Reset
+ *
+ * Forgets the stages of the previous request
+ */
+void Trace::reset() {
+  std::fill(this->spans, this->spans + Metrics::Total, -1);
+}
+
+/**
+ * @brief Sample
+ *
+ * Determines if the request about to be logged should have the time taken by
+ * each stage written to the access log
+ *
+ * @return  true for one in every N requests, otherwise false
+ */
+bool Trace::sample() {
+  return Trace::every > 0 && Trace::count.fetch_add(1,
+    std::memory_order_relaxed) % Trace::every == 0;
+}
+
+/**
+ * @brief Set Sample
+ *
+ * Sets how many requests are logged for each that has its stages logged
+ *
+ * @param  every  The number of requests (or 0 to never log the stages)
+ */
+void Trace::setSample(size_t every) {
+  Trace::every = every;
+}
+
+/**
+ * @brief Span
+ *
+ * Determines how long the request took to reach the given stage
+ *
+ * @param  stage  The stage
+ *
+ * @return        The number of microseconds, or -1 if it wasn't reached
+ */
+int64_t Trace::span(Metrics::Stage stage) const {
+  return this->spans[stage];
+}
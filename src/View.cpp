@@ -0,0 +1,162 @@
+/**
+ * @file  View.cpp
+ * @brief View
+ *
+ * Class implementation for View
+ *
+ * A View is a non-owning reference to a run of characters held elsewhere
+ * (usually the receive buffer of a Request), which allows parts of a request
+ * to be examined without copying them into strings of their own
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include "include/View.hpp"
+
+// Define storage for static members
+const size_t View::npos;
+
+/**
+ * @brief View Constructor
+ *
+ * Refers to the given run of characters
+ *
+ * @param  data    The first character
+ * @param  length  The number of characters
+ */
+View::View(const char* data, size_t length) : data{data}, length{length} {}
+
+/**
+ * @brief View Constructor
+ *
+ * Refers to the contents of the given string, which must outlive the view
+ *
+ * @param  str  The string
+ */
+View::View(const std::string& str) : data{str.data()}, length{str.length()} {}
+
+/**
+ * @brief Empty
+ *
+ * Determines if the view refers to no characters
+ *
+ * @return  true if the view is empty, otherwise false
+ */
+bool View::empty() const {
+  return this->length == 0;
+}
+
+/**
+ * @brief Equals
+ *
+ * Determines if the view refers to the same characters as another view
+ *
+ * @param  other  The other view
+ *
+ * @return        true if the characters are identical, otherwise false
+ */
+bool View::equals(const View& other) const {
+  return this->length == other.length && (this->length == 0 ||
+    memcmp(this->data, other.data, this->length) == 0);
+}
+
+/**
+ * @brief Equals
+ *
+ * Determines if the view refers to the same characters as a string
+ *
+ * @param  other  The string
+ *
+ * @return        true if the characters are identical, otherwise false
+ */
+bool View::equals(const std::string& other) const {
+  return this->equals(View{other});
+}
+
+/**
+ * @brief Find
+ *
+ * Finds the first occurrence of a character in the view
+ *
+ * @param  c      The character to find
+ * @param  start  The offset at which to begin searching
+ *
+ * @return        The offset of the character, or npos if it wasn't found
+ */
+size_t View::find(char c, size_t start) const {
+  if (start >= this->length)
+    return npos;
+  const char* found = static_cast<const char*>(memchr(this->data + start, c,
+    this->length - start));
+  return (found != nullptr ? static_cast<size_t>(found - this->data) : npos);
+}
+
+/**
+ * @brief Case-Insensitive Equals
+ *
+ * Determines if the view refers to the same characters as a lowercase string,
+ * ignoring the case of the characters in the view
+ *
+ * @param  other  The lowercase, NUL-terminated string
+ *
+ * @return        true if the characters match, otherwise false
+ */
+bool View::iequals(const char* other) const {
+  for (size_t i = 0; i < this->length; ++i, ++other)
+    if (*other == '\0' || tolower(static_cast<unsigned char>(this->data[i])) !=
+        *other)
+      return false;
+  return *other == '\0';
+}
+
+/**
+ * @brief String
+ *
+ * Copies the characters referred to by the view into a new string
+ *
+ * @return  std::string copy
+ */
+std::string View::str() const {
+  return std::string(this->data, this->length);
+}
+
+/**
+ * @brief Substring
+ *
+ * Refers to part of the view, clamped to its bounds
+ *
+ * @param  start  The offset of the first character
+ * @param  count  The maximum number of characters
+ *
+ * @return        View part
+ */
+View View::substr(size_t start, size_t count) const {
+  if (start > this->length)
+    start = this->length;
+  if (count > this->length - start)
+    count = this->length - start;
+  return View{this->data + start, count};
+}
+
+/**
+ * @brief Trim
+ *
+ * Refers to the view without any leading or trailing whitespace
+ *
+ * @return  View trimmed
+ */
+View View::trim() const {
+  size_t start = 0;
+  size_t stop  = this->length;
+  while (start < stop && isspace(static_cast<unsigned char>(this->data[start])))
+    ++start;
+  while (stop > start && isspace(static_cast<unsigned char>(this->data[stop -
+      1])))
+    --stop;
+  return View{this->data + start, stop - start};
+}
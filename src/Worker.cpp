@@ -0,0 +1,536 @@
+/**
+ * @file  Worker.cpp
+ * @brief Worker
+ *
+ * Class implementation for Worker
+ *
+ * A Worker is an event-loop thread that accepts clients from a shared listening
+ * socket and services them as non-blocking Connection objects multiplexed on
+ * its own epoll instance
+ *
+ * Alternatively, a Worker can drive its connections through its own io_uring
+ * instance: clients are accepted by a single multishot accept, and every
+ * operation queued while handling a batch of completions is submitted by the
+ * same system call that waits for the next batch
+ *
+ * Connections waiting for their Throttle stop watching their socket, and are
+ * resumed by the worker once their bandwidth limits allow it
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <memory>
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include "include/AccessLog.hpp"
+#include "include/Admission.hpp"
+#include "include/Connection.hpp"
+#include "include/FileCache.hpp"
+#include "include/IoRing.hpp"
+#include "include/Metrics.hpp"
+#include "include/Tls.hpp"
+#include "include/Trace.hpp"
+#include "include/Worker.hpp"
+#include "include/slwhttp.hpp"
+
+// The maximum number of events to collect from each call to epoll_wait(...)
+#define MAXEVENTS 256
+
+/**
+ * @brief Worker Constructor
+ *
+ * Creates an epoll instance that watches the given non-blocking listening
+ * socket for incoming clients (or an io_uring instance, if requested and
+ * supported by the kernel)
+ *
+ * @param  sockfd   The listening socket from which clients will be accepted
+ * @param  cpu      The CPU to which the worker is pinned, or -1 for none
+ * @param  backend  The interface used to wait for I/O
+ */
+Worker::Worker(int sockfd, int cpu, Backend backend): buffers{MAXHEADERS,
+    POOLBUFS}, cpu{cpu}, sockfd{sockfd} {
+  // Sessions are driven through OpenSSL, which needs the socket itself
+  if (backend == Backend::IoUring && Tls::enabled()) {
+    debug("TLS isn't supported by io_uring workers, falling back to "
+      "epoll");
+    backend = Backend::Epoll;
+  }
+#ifdef HAVE_LINUX_IO_URING_H
+  if (backend == Backend::IoUring) {
+    try {
+      this->ring.reset(new IoRing{});
+      return;
+    } catch (const std::exception& e) {
+      debug_error("{}, falling back to epoll", e.what());
+    }
+  }
+#endif
+  this->epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (this->epfd < 0)
+    throw std::runtime_error{"failed to create epoll instance"};
+  struct epoll_event event{};
+  event.events   = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+  // Only wake one of the workers sharing the listening socket per client
+  event.events  |= EPOLLEXCLUSIVE;
+#endif
+  event.data.fd  = this->sockfd;
+  if (epoll_ctl(this->epfd, EPOLL_CTL_ADD, this->sockfd, &event) < 0) {
+    close(this->epfd);
+    throw std::runtime_error{"failed to watch listening socket"};
+  }
+}
+
+/**
+ * @brief Worker Destructor
+ *
+ * Disconnects all remaining clients and closes the epoll instance
+ */
+Worker::~Worker() {
+  this->join();
+#ifdef HAVE_LINUX_IO_URING_H
+  // Cancel any io_uring operations before releasing the buffers they use
+  this->ring.reset();
+#endif
+  this->clients.clear();
+  if (this->epfd >= 0)
+    close(this->epfd);
+}
+
+/**
+ * @brief Accept Clients
+ *
+ * Accepts all pending clients from the listening socket
+ */
+void Worker::acceptClients() {
+  while (true) {
+    struct sockaddr_storage peer{};
+    socklen_t length = sizeof(peer);
+    int clifd = accept4(this->sockfd, reinterpret_cast<struct sockaddr*>(&peer),
+      &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (clifd < 0) {
+      // Another worker may have accepted the client first
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        debug_error("error accepting client");
+      break;
+    }
+    this->addClient(clifd, peer);
+  }
+}
+
+/**
+ * @brief Add Client
+ *
+ * Starts servicing a newly accepted client
+ *
+ * @param  fd    The file descriptor of the client
+ * @param  peer  The address of the client
+ */
+void Worker::addClient(int fd, const struct sockaddr_storage& peer) {
+  debug("accepted client: {}", fd);
+  Metrics::add(Metrics::Accepts);
+  TRACEPOINT(accept, fd, Admission::connected());
+  // Turn the client away before taking it on if too many are already
+  // connected (the connection leaves Admission once it is destroyed)
+  if (Admission::admit() == false) {
+    Admission::reject(fd);
+    return;
+  }
+  prepare_client(fd);
+  Client& client = this->clients[fd];
+  client.connection.reset(new Connection{fd, this->buffers, peer});
+#ifdef HAVE_LINUX_IO_URING_H
+  if (this->ring) {
+    if (client.connection->submit(*this->ring) == false &&
+        client.connection->pending() == 0)
+      this->clients.erase(fd);
+    return;
+  }
+#endif
+  client.events = client.connection->events();
+  struct epoll_event event{};
+  event.events  = client.events;
+  event.data.fd = fd;
+  if (epoll_ctl(this->epfd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    debug_error("failed to watch client: {}", fd);
+    this->clients.erase(fd);
+  }
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Arm Accept
+ *
+ * Submits an accept of the listening socket that (where supported) keeps
+ * completing once for every client
+ */
+void Worker::armAccept() {
+  struct io_uring_sqe* sqe = this->ring->next();
+  sqe->opcode       = IORING_OP_ACCEPT;
+  sqe->fd           = this->sockfd;
+  // io_uring waits for the socket itself, so clients are left blocking
+  sqe->accept_flags = SOCK_CLOEXEC;
+#ifdef IORING_ACCEPT_MULTISHOT
+  if (this->multishot == true)
+    sqe->ioprio     = IORING_ACCEPT_MULTISHOT;
+#endif
+  sqe->user_data    = RINGTAG(this->sockfd, Accept);
+}
+
+/**
+ * @brief Arm Timer
+ *
+ * Submits a timeout that completes after one second
+ */
+void Worker::armTimer() {
+  struct io_uring_sqe* sqe = this->ring->next();
+  sqe->opcode    = IORING_OP_TIMEOUT;
+  sqe->addr      = reinterpret_cast<uint64_t>(&this->interval);
+  sqe->len       = 1;
+  sqe->user_data = RINGTAG(0, Timer);
+}
+#endif
+
+/**
+ * @brief Close Client
+ *
+ * Stops watching the given client and disconnects it (once none of its
+ * io_uring operations are still in flight)
+ *
+ * @param  fd  The file descriptor of the associated client
+ */
+void Worker::closeClient(int fd) {
+#ifdef HAVE_LINUX_IO_URING_H
+  if (this->ring) {
+    auto it = this->clients.find(fd);
+    if (it != this->clients.end() && it->second.connection->disconnect() ==
+        false && it->second.connection->pending() == 0)
+      this->clients.erase(it);
+    return;
+  }
+#endif
+  epoll_ctl(this->epfd, EPOLL_CTL_DEL, fd, NULL);
+  this->clients.erase(fd);
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Complete Ring
+ *
+ * Handles the completion of one of the worker's io_uring operations
+ *
+ * @param  cqe  The completion queue entry
+ */
+void Worker::completeRing(const struct io_uring_cqe& cqe) {
+  int      fd        = static_cast<int>(cqe.user_data >> 8);
+  unsigned operation = static_cast<unsigned>(cqe.user_data & 0xff);
+  if (operation == Accept) {
+    if (cqe.res >= 0) {
+      // The address of each client is only needed for the access log
+      struct sockaddr_storage peer{};
+      socklen_t length = sizeof(peer);
+      if (AccessLog::enabled())
+        getpeername(cqe.res, reinterpret_cast<struct sockaddr*>(&peer),
+          &length);
+      this->addClient(cqe.res, peer);
+    }
+    else if (cqe.res == -EINVAL && this->multishot == true)
+      // Multishot accepts need Linux 5.19 or later
+      this->multishot = false;
+    else if (cqe.res != -EAGAIN && cqe.res != -EINTR)
+      debug("error accepting client: {}", -cqe.res);
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0 && this->listening == true)
+      this->armAccept();
+    return;
+  }
+  if (operation == Cancel)
+    return;
+  if (operation == Timer) {
+    this->expireClients();
+    this->armTimer();
+    return;
+  }
+  auto it = this->clients.find(fd);
+  if (it == this->clients.end())
+    return;
+  Connection& connection = *it->second.connection;
+  if (connection.complete(*this->ring, static_cast<Connection::Operation>(
+      operation), cqe.res) == false && connection.pending() == 0)
+    this->clients.erase(it);
+}
+#endif
+
+/**
+ * @brief Drain
+ *
+ * Stops accepting clients once the listening sockets have been handed to a new
+ * process, leaving the worker to finish serving the clients it already has
+ */
+void Worker::drain() {
+  this->listening = false;
+#ifdef HAVE_LINUX_IO_URING_H
+  if (this->ring) {
+    struct io_uring_sqe* sqe = this->ring->next();
+    sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+    sqe->addr      = RINGTAG(this->sockfd, Accept);
+    sqe->user_data = RINGTAG(0, Cancel);
+  }
+  else
+#endif
+    epoll_ctl(this->epfd, EPOLL_CTL_DEL, this->sockfd, NULL);
+  debug("worker draining {} clients", this->clients.size());
+}
+
+/**
+ * @brief Expire Clients
+ *
+ * Disconnects all clients that have stalled for longer than allowed (and,
+ * while draining, those idling between requests)
+ */
+void Worker::expireClients() {
+  auto now = std::chrono::steady_clock::now();
+  std::vector<int> expired{};
+  for (const auto& client : this->clients)
+    if (client.second.connection->expired(now) || (this->listening == false &&
+        client.second.connection->idle()))
+      expired.push_back(client.first);
+  for (int fd : expired)
+    this->closeClient(fd);
+}
+
+/**
+ * @brief Join
+ *
+ * Waits for the worker's event loop to finish
+ */
+void Worker::join() {
+  if (this->thread.joinable())
+    this->thread.join();
+}
+
+/**
+ * @brief Resume Clients
+ *
+ * Continues sending to each throttled client whose bandwidth limits allow it
+ */
+void Worker::resumeClients() {
+  if (this->throttled.empty())
+    return;
+  auto now = std::chrono::steady_clock::now();
+  std::vector<int> throttled{};
+  throttled.swap(this->throttled);
+  for (int fd : throttled) {
+    auto it = this->clients.find(fd);
+    if (it == this->clients.end() || it->second.connection->paused() ==
+        std::chrono::steady_clock::time_point{})
+      continue;
+    if (it->second.connection->paused() > now)
+      this->throttled.push_back(fd);
+    else if (it->second.connection->handle(EPOLLOUT) == false)
+      this->closeClient(fd);
+    else if (it->second.connection->paused() !=
+        std::chrono::steady_clock::time_point{})
+      // Still waiting, and still not watching its socket
+      this->throttled.push_back(fd);
+    else
+      this->updateClient(fd, it->second);
+  }
+}
+
+/**
+ * @brief Run
+ *
+ * Services clients until the listening socket becomes invalid (or has been
+ * handed to a new process and the last client is gone)
+ */
+void Worker::run() {
+  if (this->cpu >= 0) {
+    // Keep the worker (and therefore the caches of its clients) on one CPU
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(this->cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+      debug_error("failed to pin worker to CPU {}", this->cpu);
+    FileCache::pin(this->cpu);
+  }
+#ifdef HAVE_LINUX_IO_URING_H
+  if (this->ring) {
+    this->runRing();
+    return;
+  }
+#endif
+  struct epoll_event events[MAXEVENTS];
+  auto last_expiry = std::chrono::steady_clock::now();
+  while (valid(this->sockfd) && (this->listening == true ||
+      this->clients.size() > 0)) {
+    if (this->listening == true && _draining.load() == true)
+      this->drain();
+    // Wake at least once per second to drop stalled clients (and in time to
+    // resume the first throttled client)
+    auto wait = std::chrono::milliseconds{1000};
+    auto now  = std::chrono::steady_clock::now();
+    for (int fd : this->throttled) {
+      auto it = this->clients.find(fd);
+      if (it != this->clients.end())
+        wait = std::min(wait, std::chrono::duration_cast<
+          std::chrono::milliseconds>(it->second.connection->paused() - now +
+          std::chrono::milliseconds{1}));
+    }
+    int count = epoll_wait(this->epfd, events, MAXEVENTS, static_cast<int>(
+      std::max<int64_t>(0, wait.count())));
+    if (count < 0 && errno != EINTR) {
+      debug_error("error waiting for events");
+      break;
+    }
+    for (int i = 0; i < count; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == this->sockfd) {
+        this->acceptClients();
+        continue;
+      }
+      auto it = this->clients.find(fd);
+      if (it == this->clients.end())
+        continue;
+      if (it->second.connection->handle(events[i].events))
+        this->updateClient(fd, it->second);
+      else
+        this->closeClient(fd);
+    }
+    this->resumeClients();
+    now = std::chrono::steady_clock::now();
+    if (now - last_expiry >= std::chrono::seconds{1}) {
+      this->expireClients();
+      last_expiry = now;
+    }
+  }
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+/**
+ * @brief Run Ring
+ *
+ * Services clients through the worker's io_uring instance until the listening
+ * socket becomes invalid (or has been handed to a new process and the last
+ * client is gone)
+ */
+void Worker::runRing() {
+  this->armAccept();
+  // Wake at least once per second to drop stalled clients
+  this->armTimer();
+  while (valid(this->sockfd) && (this->listening == true ||
+      this->clients.size() > 0)) {
+    if (this->listening == true && _draining.load() == true)
+      this->drain();
+    // Submit everything queued since the last batch of completions and wait
+    // for the next batch
+    if (this->ring->submit(1) < 0 && errno != EINTR && errno != EAGAIN &&
+        errno != EBUSY) {
+      debug_error("error waiting for completions");
+      break;
+    }
+    this->ring->reap([this](const struct io_uring_cqe& cqe) {
+      this->completeRing(cqe);
+    });
+  }
+}
+#endif
+
+/**
+ * @brief Serve
+ *
+ * Services the given listening sockets with a fixed pool of workers and waits
+ * for all of them to finish
+ *
+ * Workers are assigned listening sockets round-robin, so a single socket is
+ * shared by every worker while one socket per worker (bound using
+ * SO_REUSEPORT) gives each worker its own accept queue.  Pinned workers with
+ * sockets of their own are also handed the clients whose packets arrive on
+ * their CPU where the kernel supports it (SO_INCOMING_CPU)
+ *
+ * @param  sockfds  The listening sockets from which clients will be accepted
+ * @param  count    The number of workers to start
+ * @param  pin      Whether or not each worker should be pinned to its own CPU
+ * @param  backend  The interface each worker uses to wait for I/O
+ */
+void Worker::serve(const std::vector<int>& sockfds, int count, bool pin,
+    Backend backend) {
+  // Workers race to accept each client, so the losers must not block
+  for (int sockfd : sockfds) {
+    int flags = fcntl(sockfd, F_GETFL);
+    if (flags < 0 || fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) < 0)
+      throw std::runtime_error{"failed to make listening socket non-blocking"};
+  }
+  // Determine which CPUs the process is allowed to run on
+  std::vector<int> cpus{};
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pin == true && sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+  std::vector<std::unique_ptr<Worker>> workers{};
+  for (int i = 0; i < count; ++i) {
+    int cpu = (cpus.size() > 0 ? cpus[i % cpus.size()] : -1);
+    int sockfd = sockfds[i % sockfds.size()];
+#ifdef SO_INCOMING_CPU
+    // Ask the kernel to prefer the listening socket of the worker pinned to
+    // the CPU that received each client's packets, so that the client's
+    // packets and requests are all handled by the same CPU
+    if (cpu >= 0 && sockfds.size() >= static_cast<size_t>(count) &&
+        setsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &cpu,
+          sizeof(cpu)) != 0)
+      debug_error("failed to steer clients to CPU {}", cpu);
+#endif
+    workers.emplace_back(new Worker{sockfd, cpu, backend});
+  }
+  debug("begin accepting clients securely with {} workers on {} listening "
+    "sockets", count, sockfds.size());
+  for (auto& worker : workers)
+    worker->start();
+  for (auto& worker : workers)
+    worker->join();
+}
+
+/**
+ * @brief Start
+ *
+ * Starts the worker's event loop on its own thread
+ */
+void Worker::start() {
+  this->thread = std::thread{&Worker::run, this};
+}
+
+/**
+ * @brief Update Client
+ *
+ * Changes the events watched for the given client to match its state,
+ * remembering it to be resumed if it is waiting for its throttle
+ *
+ * @param  fd      The file descriptor of the associated client
+ * @param  client  The client's bookkeeping entry
+ */
+void Worker::updateClient(int fd, Client& client) {
+  uint32_t events = client.connection->events();
+  if (events != client.events) {
+    struct epoll_event event{};
+    event.events  = events;
+    event.data.fd = fd;
+    if (epoll_ctl(this->epfd, EPOLL_CTL_MOD, fd, &event) < 0)
+      this->closeClient(fd);
+    else {
+      client.events = events;
+      if (events == 0)
+        this->throttled.push_back(fd);
+    }
+  }
+}
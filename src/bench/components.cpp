@@ -0,0 +1,183 @@
+/**
+ * @file  components.cpp
+ * @brief Request Path Micro-Benchmarks
+ *
+ * Measures the time and heap allocations taken by each component on the path
+ * of a request, apart from socket I/O: parsing the request headers from a
+ * memory buffer, resolving the request path, sandboxing it (or opening it
+ * beneath the jail, or looking it up in the static tree), looking it up in the
+ * file cache and building the response header
+ *
+ * Build and run it using `make microbench`
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "bench/harness.hpp"
+#include "include/BufferPool.hpp"
+#include "include/FileCache.hpp"
+#include "include/Request.hpp"
+#include "include/Response.hpp"
+#include "include/SandboxPath.hpp"
+#include "include/StaticTree.hpp"
+#include "include/slwhttp.hpp"
+
+/**
+ * @brief Feed
+ *
+ * Copies request headers into a request as if they were read from a client
+ *
+ * @param  request  The request
+ * @param  text     The request headers
+ */
+static void feed(Request& request, const std::string& text) {
+  size_t length = 0;
+  char*  buffer = request.space(length);
+  if (length > text.length())
+    length = text.length();
+  memcpy(buffer, text.data(), length);
+  request.received(length);
+}
+
+/**
+ * @brief Write File
+ *
+ * Creates a file filled with a repeated character
+ *
+ * @param  path    The path of the file
+ * @param  length  The size of the file
+ */
+static void write_file(const std::string& path, size_t length) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    perror(path.c_str());
+    exit(EXIT_FAILURE);
+  }
+  std::string data(length, 'a');
+  fwrite(data.data(), 1, data.length(), file);
+  fclose(file);
+}
+
+int main() {
+  // Build a small document root to resolve paths against
+  char temporary[] = "/tmp/slwhttp-bench.XXXXXX";
+  if (mkdtemp(temporary) == nullptr) {
+    perror("mkdtemp");
+    return EXIT_FAILURE;
+  }
+  const std::string root{temporary};
+  const std::string page{root + "/docs/guide/page.html"};
+  mkdir((root + "/docs").c_str(), 0755);
+  mkdir((root + "/docs/guide").c_str(), 0755);
+  write_file(root + INDEX, 4096);
+  write_file(page, 4096);
+  _htdocs = root;
+  SandboxPath::setJail(root);
+
+  // A typical browser request, and the same request with a Range header
+  const std::string text{
+    "GET /docs/guide/page.html HTTP/1.1\r\n"
+    "Host: localhost\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 "
+      "Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8"
+      "\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Referer: http://localhost/\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "\r\n"
+  };
+  const std::string range{text.substr(0, text.length() - 2) +
+    "Range: bytes=100-199\r\n\r\n"};
+  BufferPool pool{MAXHEADERS, 8};
+  volatile size_t sink = 0;
+
+  report("Request: parse headers", measure([&]() {
+    Request request{pool};
+    feed(request, text);
+    sink = sink + request.complete() + request.keepAlive() +
+      request.header("accept-encoding").length;
+  }));
+  report("Request: parse, consume and reuse", measure([&]() {
+    static Request request{pool};
+    feed(request, text);
+    sink = sink + request.complete() + request.keepAlive();
+    request.consume();
+  }));
+
+  Request request{pool};
+  feed(request, text);
+  std::string path{};
+  report("request_path", measure([&]() {
+    sink = sink + request_path(request, path);
+  }));
+
+  report("SandboxPath: construct", measure([&]() {
+    SandboxPath sandbox{page};
+    sink = sink + sandbox.get().length();
+  }));
+  report("SandboxPath::checkJail", measure([&]() {
+    sink = sink + SandboxPath::checkJail(page);
+  }));
+
+  std::string rpath{};
+  report("SandboxPath::open", measure([&]() {
+    int fd = SandboxPath::open(page, rpath);
+    if (fd >= 0)
+      close(fd);
+    sink = sink + static_cast<size_t>(fd);
+  }));
+
+  FileCache::setCapacity(0);
+  report("FileCache::open (uncached)", measure([&]() {
+    sink = sink + FileCache::open(page)->size;
+  }));
+  FileCache::setCapacity(64);
+  report("FileCache::open (cached)", measure([&]() {
+    sink = sink + FileCache::open(page)->size;
+  }));
+
+  // Build each kind of response header for the cached file
+  std::shared_ptr<const FileCache::Entry> file = FileCache::open(page);
+  Request ranged{pool};
+  feed(ranged, range);
+  Request revalidation{pool};
+  feed(revalidation, text.substr(0, text.length() - 2) + "If-None-Match: " +
+    file->etag + "\r\n\r\n");
+  const struct { const char* name; const Request& request; } responses[] = {
+    {"Response::serve (200)", request},
+    {"Response::serve (206)", ranged},
+    {"Response::serve (304)", revalidation}
+  };
+  for (const auto& response : responses)
+    report(response.name, measure([&]() {
+      struct iovec iov[RESPONSEBUFS];
+      sink = sink + static_cast<size_t>(Response::serve(file,
+        response.request, true).buffers(iov));
+    }));
+
+  // Look the same path up in an index of the document root instead
+  StaticTree::build(root);
+  report("StaticTree::find", measure([&]() {
+    sink = sink + StaticTree::find(page, rpath);
+  }));
+
+  // Clean up the document root
+  unlink(page.c_str());
+  unlink((root + INDEX).c_str());
+  rmdir((root + "/docs/guide").c_str());
+  rmdir((root + "/docs").c_str());
+  rmdir(root.c_str());
+  return EXIT_SUCCESS;
+}
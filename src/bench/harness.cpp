@@ -0,0 +1,88 @@
+/**
+ * @file  harness.cpp
+ * @brief Micro-Benchmark Harness
+ *
+ * Counts heap allocations by replacing the global allocation functions, and
+ * reports measurements in a fixed-width table
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "bench/harness.hpp"
+
+std::atomic<size_t> _allocations{0};
+
+/**
+ * @brief Operator New
+ *
+ * Allocates memory, counting the allocation
+ *
+ * @param  size  The number of bytes to allocate
+ *
+ * @return       The allocated memory
+ */
+void* operator new(size_t size) {
+  _allocations.fetch_add(1, std::memory_order_relaxed);
+  void* memory = malloc(size > 0 ? size : 1);
+  if (memory == nullptr)
+    throw std::bad_alloc{};
+  return memory;
+}
+
+/**
+ * @brief Operator New[]
+ *
+ * Allocates memory for an array, counting the allocation
+ *
+ * @param  size  The number of bytes to allocate
+ *
+ * @return       The allocated memory
+ */
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+/**
+ * @brief Operator Delete
+ *
+ * Frees memory allocated by operator new
+ *
+ * @param  memory  The memory to free
+ */
+void operator delete(void* memory) noexcept {
+  free(memory);
+}
+
+/**
+ * @brief Operator Delete[]
+ *
+ * Frees memory allocated by operator new[]
+ *
+ * @param  memory  The memory to free
+ */
+void operator delete[](void* memory) noexcept {
+  free(memory);
+}
+
+/**
+ * @brief Report
+ *
+ * Prints a measurement as a row of the results table
+ *
+ * @param  name         The name of the measured function
+ * @param  measurement  The measurement
+ */
+void report(const char* name, const Measurement& measurement) {
+  static bool header = false;
+  if (header == false) {
+    printf("%-36s %12s %12s\n", "benchmark", "ns/op", "allocs/op");
+    header = true;
+  }
+  printf("%-36s %12.1f %12.2f\n", name, measurement.nanoseconds,
+    measurement.allocations);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file  harness.hpp
+ * @brief Micro-Benchmark Harness
+ *
+ * Definitions shared by the micro-benchmarks: a function that measures the
+ * average time and number of heap allocations taken by a call, and a function
+ * that reports the measurement
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _HARNESS_HPP
+#define _HARNESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+// The number of heap allocations made so far (counted by the replacement
+// operator new in harness.cpp)
+extern std::atomic<size_t> _allocations;
+
+/**
+ * @struct Measurement
+ * @brief  The average cost of a single call to a measured function
+ */
+struct Measurement {
+  double  allocations = 0;
+  double  nanoseconds = 0;
+};
+
+void report(const char* name, const Measurement& measurement);
+
+/**
+ * @brief Measure
+ *
+ * Measures a function over enough iterations to run for roughly a fifth of a
+ * second (after a single warm-up call)
+ *
+ * @param  function  The function to measure
+ *
+ * @return           The average time and allocations per call
+ */
+template <typename Function>
+Measurement measure(Function function) {
+  typedef std::chrono::steady_clock clock;
+  function();
+  size_t iterations = 1;
+  while (true) {
+    size_t            allocations = _allocations.load();
+    clock::time_point start       = clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+      function();
+    double elapsed = std::chrono::duration<double, std::nano>(clock::now() -
+      start).count();
+    if (elapsed > 2e8 || iterations >= (static_cast<size_t>(1) << 30)) {
+      Measurement measurement{};
+      measurement.allocations = static_cast<double>(_allocations.load() -
+        allocations) / static_cast<double>(iterations);
+      measurement.nanoseconds = elapsed / static_cast<double>(iterations);
+      return measurement;
+    }
+    iterations *= 2;
+  }
+}
+
+#endif
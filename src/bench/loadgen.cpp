@@ -0,0 +1,470 @@
+/**
+ * @file  loadgen.cpp
+ * @brief HTTP Load Generator
+ *
+ * Small closed-loop load generator used by `make bench`: each connection sends
+ * a request, waits for the whole response and then sends the next one for a
+ * fixed amount of time, recording the latency of every request
+ *
+ * Optionally, extra slow clients trickle out their request headers one byte at
+ * a time alongside the measured connections, and the CPU time used by the
+ * server process is sampled from /proc to report the CPU cost per request.
+ * A summary is printed, and appended to a file as a line of JSON if requested
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <algorithm>      // for sort, min
+#include <arpa/inet.h>    // for inet_pton
+#include <cctype>         // for tolower
+#include <cerrno>         // for errno, EINTR
+#include <chrono>         // for steady_clock, duration_cast, etc
+#include <cstdint>        // for int64_t, uint32_t
+#include <cstdio>         // for fopen, fprintf, snprintf, etc
+#include <cstdlib>        // for exit, EXIT_FAILURE, strtoll, etc
+#include <cstring>        // for memset, strrchr
+#include <functional>     // for ref
+#include <iostream>       // for operator<<, basic_ostream, endl, etc
+#include <netinet/in.h>   // for sockaddr_in, htons
+#include <netinet/tcp.h>  // for TCP_NODELAY
+#include <stdexcept>      // for exception, runtime_error
+#include <string>         // for string, allocator, operator+, etc
+#include <sys/socket.h>   // for socket, connect, send, recv, etc
+#include <sys/time.h>     // for timeval
+#include <thread>         // for thread
+#include <unistd.h>       // for close, sysconf
+#include <vector>         // for vector
+
+// Define storage for global configuration state
+int                _connections = 16;
+double                _duration = 5;
+int                     _expect = 200;
+std::vector<std::string> _headers{};
+std::string               _host = "127.0.0.1";
+bool                 _keepalive = true;
+std::string               _name = "";
+std::string             _output = "";
+std::string               _path = "/";
+int                        _pid = 0;
+int                       _port = 80;
+bool                _revalidate = false;
+int                       _slow = 0;
+
+/**
+ * @struct Totals
+ * @brief  The results collected by a single connection
+ */
+struct Totals {
+  int64_t                 bytes = 0;
+  int64_t                errors = 0;
+  std::vector<uint32_t> latencies{};
+};
+
+// Function prototypes
+int         connect_client();
+int64_t     cpu_time(int pid);
+bool        exchange(int& fd, const std::string& request, std::string& buffer,
+              int& status, int64_t& bytes, std::string* etag = nullptr);
+void        print_help(bool should_exit = true);
+void        run_client(const std::string& request,
+              std::chrono::steady_clock::time_point deadline, Totals& totals);
+void        run_slow_client(const std::string& request,
+              std::chrono::steady_clock::time_point deadline);
+
+int main(int argc, const char* argv[]) {
+  // Gather a vector of all arguments from argv[]
+  std::vector<std::string> arguments{};
+  for (int i = 1; i < argc; ++i)
+    arguments.push_back(argv[i]);
+
+  // Iterate over the options until no more arguments exist
+  for (auto it = arguments.begin(); it != arguments.end(); ++it) {
+    const std::string& option = *it;
+    if (option == "--help")
+      print_help();
+    else if (option == "--no-keepalive")
+      _keepalive = false;
+    else if (option == "--revalidate")
+      _revalidate = true;
+    else if (it + 1 == arguments.end()) {
+      std::cerr << "Error: no value was provided for " << option << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    else if (option == "--header")
+      _headers.push_back(*(++it));
+    else if (option == "--host")
+      _host = *(++it);
+    else if (option == "--name")
+      _name = *(++it);
+    else if (option == "--output")
+      _output = *(++it);
+    else if (option == "--path")
+      _path = *(++it);
+    else {
+      try {
+        if (option == "--connections")
+          _connections = std::stoi(*(++it));
+        else if (option == "--duration")
+          _duration    = std::stod(*(++it));
+        else if (option == "--expect")
+          _expect      = std::stoi(*(++it));
+        else if (option == "--pid")
+          _pid         = std::stoi(*(++it));
+        else if (option == "--port")
+          _port        = std::stoi(*(++it));
+        else if (option == "--slow")
+          _slow        = std::stoi(*(++it));
+        else {
+          std::cerr << "Error: unknown option " << option << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      } catch (const std::exception& e) {
+        std::cerr << "Error: the value provided for " << option << " is not a "
+          "valid number" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+  if (_connections < 1 || _duration <= 0 || _slow < 0) {
+    std::cerr << "Error: connections and duration must be positive"
+      << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Build the request that every connection sends
+  std::string request{"GET " + _path + " HTTP/1.1\r\nHost: " + _host + "\r\n"};
+  for (const std::string& header : _headers)
+    request += header + "\r\n";
+  if (_keepalive == false)
+    request += "Connection: close\r\n";
+  // Revalidate the current entity-tag of the file if requested
+  if (_revalidate == true) {
+    int         fd     = -1;
+    int         status = 0;
+    int64_t     bytes  = 0;
+    std::string buffer{};
+    std::string etag{};
+    if (exchange(fd, request + "Connection: close\r\n\r\n", buffer, status,
+        bytes, &etag) == false || etag.length() == 0) {
+      std::cerr << "Error: could not fetch the ETag of " << _path << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (fd >= 0)
+      close(fd);
+    request += "If-None-Match: " + etag + "\r\n";
+  }
+  request += "\r\n";
+
+  // Run every connection (and slow client) until the deadline
+  typedef std::chrono::steady_clock clock;
+  std::vector<Totals>      totals(static_cast<size_t>(_connections));
+  std::vector<std::thread> threads{};
+  int64_t           cpu_start = cpu_time(_pid);
+  clock::time_point start     = clock::now();
+  clock::time_point deadline  = start + std::chrono::duration_cast<
+    clock::duration>(std::chrono::duration<double>{_duration});
+  for (int i = 0; i < _slow; ++i)
+    threads.emplace_back(run_slow_client, request, deadline);
+  for (Totals& total : totals)
+    threads.emplace_back(run_client, request, deadline, std::ref(total));
+  for (std::thread& thread : threads)
+    thread.join();
+  double  elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  int64_t cpu_end = cpu_time(_pid);
+
+  // Combine the results of every connection
+  std::vector<uint32_t> latencies{};
+  int64_t bytes  = 0;
+  int64_t errors = 0;
+  for (const Totals& total : totals) {
+    latencies.insert(latencies.end(), total.latencies.begin(),
+      total.latencies.end());
+    bytes  += total.bytes;
+    errors += total.errors;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double quantile) -> uint32_t {
+    if (latencies.size() == 0)
+      return 0;
+    size_t rank = static_cast<size_t>(quantile *
+      static_cast<double>(latencies.size()) + 0.999999);
+    return latencies[std::min(latencies.size(), std::max<size_t>(rank, 1)) - 1];
+  };
+  size_t requests = latencies.size();
+  double rps      = static_cast<double>(requests) / elapsed;
+  char   cpu[32]  = "null";
+  if (cpu_start >= 0 && cpu_end >= 0 && requests > 0)
+    snprintf(cpu, sizeof(cpu), "%.2f", static_cast<double>(cpu_end -
+      cpu_start) / static_cast<double>(requests));
+
+  char summary[1024] = {};
+  snprintf(summary, sizeof(summary), "{\"scenario\":\"%s\",\"path\":\"%s\","
+    "\"connections\":%d,\"slow_clients\":%d,\"keepalive\":%s,"
+    "\"duration_s\":%.3f,\"requests\":%zu,\"errors\":%lld,\"bytes\":%lld,"
+    "\"rps\":%.1f,\"latency_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,"
+    "\"p999\":%u,\"max\":%u},\"cpu_us_per_request\":%s}", _name.c_str(),
+    _path.c_str(), _connections, _slow, (_keepalive ? "true" : "false"),
+    elapsed, requests, static_cast<long long>(errors),
+    static_cast<long long>(bytes), rps, percentile(0.5), percentile(0.9),
+    percentile(0.99), percentile(0.999), percentile(1), cpu);
+  std::cout << summary << std::endl;
+  if (_output.length() > 0) {
+    FILE* file = fopen(_output.c_str(), "a");
+    if (file == nullptr || fprintf(file, "%s\n", summary) < 0) {
+      std::cerr << "Error: could not write " << _output << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    fclose(file);
+  }
+  return (requests > 0 && errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * @brief Connect Client
+ *
+ * Opens a connection to the server being measured
+ *
+ * @return  The file descriptor of the connection, or -1 on failure
+ */
+int connect_client() {
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port   = htons(_port);
+  if (inet_pton(AF_INET, _host.c_str(), &address.sin_addr) != 1)
+    return -1;
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+  int yes = 1;
+  struct timeval timeout{10, 0};
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief CPU Time
+ *
+ * Reads the user and system CPU time used by a process so far
+ *
+ * @param  pid  The process ID (or 0 to skip measuring)
+ *
+ * @return      The number of microseconds of CPU time, or -1 if unknown
+ */
+int64_t cpu_time(int pid) {
+  if (pid <= 0)
+    return -1;
+  std::string path{"/proc/" + std::to_string(pid) + "/stat"};
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr)
+    return -1;
+  char line[1024] = {};
+  size_t length = fread(line, 1, sizeof(line) - 1, file);
+  fclose(file);
+  line[length] = '\0';
+  // Skip past the command name (which may contain spaces) to the state field,
+  // then to the utime and stime fields (the 14th and 15th)
+  const char* fields = strrchr(line, ')');
+  if (fields == nullptr)
+    return -1;
+  unsigned long long utime = 0, stime = 0;
+  if (sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu "
+      "%llu", &utime, &stime) != 2)
+    return -1;
+  return static_cast<int64_t>((utime + stime) * 1000000ULL /
+    static_cast<unsigned long long>(sysconf(_SC_CLK_TCK)));
+}
+
+/**
+ * @brief Exchange
+ *
+ * Sends a request (connecting first if necessary) and reads the complete
+ * response, leaving the connection open unless the server is closing it
+ *
+ * @param[out]  fd       The connection (or -1 to open a new one)
+ * @param       request  The request
+ * @param       buffer   Scratch space for the response
+ * @param[out]  status   The status code of the response
+ * @param[out]  bytes    The size of the response body
+ * @param[out]  etag     Receives the ETag header of the response if not null
+ *
+ * @return               true if a complete response was read, otherwise false
+ */
+bool exchange(int& fd, const std::string& request, std::string& buffer,
+    int& status, int64_t& bytes, std::string* etag) {
+  if (fd < 0 && (fd = connect_client()) < 0)
+    return false;
+  if (send(fd, request.data(), request.length(), MSG_NOSIGNAL) !=
+      static_cast<ssize_t>(request.length()))
+    return false;
+  // Read until the end of the response header
+  buffer.clear();
+  char   chunk[65536];
+  size_t end = std::string::npos;
+  while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t data_read = recv(fd, chunk, sizeof(chunk), 0);
+    if (data_read < 0 && errno == EINTR)
+      continue;
+    if (data_read <= 0)
+      return false;
+    buffer.append(chunk, static_cast<size_t>(data_read));
+  }
+  end += 4;
+  if (buffer.compare(0, 9, "HTTP/1.1 ") != 0 && buffer.compare(0, 9,
+      "HTTP/1.0 ") != 0)
+    return false;
+  status = atoi(buffer.c_str() + 9);
+  // Find the length of the body and whether the connection persists
+  std::string header{buffer, 0, end};
+  std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+  size_t field = header.find("\r\ncontent-length:");
+  int64_t length = (field != std::string::npos ? strtoll(header.c_str() +
+    field + 17, nullptr, 10) : 0);
+  bool closing = header.find("\r\nconnection: close") != std::string::npos;
+  if (etag != nullptr && (field = header.find("\r\netag:")) !=
+      std::string::npos) {
+    size_t first = buffer.find_first_not_of(' ', field + 7);
+    *etag = buffer.substr(first, buffer.find("\r\n", first) - first);
+  }
+  // Read (and discard) the rest of the body
+  int64_t remaining = length - static_cast<int64_t>(buffer.length() - end);
+  while (remaining > 0) {
+    ssize_t data_read = recv(fd, chunk, static_cast<size_t>(std::min<int64_t>(
+      remaining, sizeof(chunk))), 0);
+    if (data_read < 0 && errno == EINTR)
+      continue;
+    if (data_read <= 0)
+      return false;
+    remaining -= data_read;
+  }
+  bytes = length;
+  if (closing == true) {
+    close(fd);
+    fd = -1;
+  }
+  return true;
+}
+
+/**
+ * @brief Print Help
+ *
+ * Prints help information and optionally calls exit(...)
+ *
+ * @param  should_exit  Bool saying whether or not the program should exit upon
+ *                      completion of the function
+ */
+void print_help(bool should_exit) {
+  std::cerr << "Usage: slwhttp-loadgen [OPTIONS]" << std::endl
+            << "Measures the throughput and latency of an HTTP server."
+            << std::endl << std::endl
+            << "Command line options:" << std::endl
+            << "  --connections  number of concurrent connections (default: 16)"
+            << std::endl
+            << "  --duration     seconds to run for (default: 5)" << std::endl
+            << "  --expect       expected status code (default: 200)"
+            << std::endl
+            << "  --header       add a request header line (repeatable)"
+            << std::endl
+            << "  --help         display this help and exit" << std::endl
+            << "  --host         server IPv4 address (default: 127.0.0.1)"
+            << std::endl
+            << "  --name         scenario name for the results" << std::endl
+            << "  --no-keepalive open a new connection for every request"
+            << std::endl
+            << "  --output       append the results as JSON to FILE"
+            << std::endl
+            << "  --path         request target (default: /)" << std::endl
+            << "  --pid          measure the CPU time used by process PID"
+            << std::endl
+            << "  --port         server port (default: 80)" << std::endl
+            << "  --revalidate   send If-None-Match with the current ETag"
+            << std::endl
+            << "  --slow         add N clients that trickle their requests"
+            << std::endl;
+  if (should_exit == true)
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Run Client
+ *
+ * Sends requests over a connection until the deadline, recording the latency
+ * of each response
+ *
+ * @param  request   The request
+ * @param  deadline  When to stop sending requests
+ * @param  totals    The results of the connection
+ */
+void run_client(const std::string& request,
+    std::chrono::steady_clock::time_point deadline, Totals& totals) {
+  typedef std::chrono::steady_clock clock;
+  std::string buffer{};
+  int fd = -1;
+  totals.latencies.reserve(65536);
+  for (clock::time_point now = clock::now(); now < deadline;) {
+    int     status = 0;
+    int64_t bytes  = 0;
+    bool    valid  = exchange(fd, request, buffer, status, bytes);
+    clock::time_point done = clock::now();
+    if (valid == true && status == _expect) {
+      totals.latencies.push_back(static_cast<uint32_t>(std::chrono::
+        duration_cast<std::chrono::microseconds>(done - now).count()));
+      totals.bytes += bytes;
+    }
+    else {
+      ++totals.errors;
+      if (fd >= 0)
+        close(fd);
+      fd = -1;
+    }
+    now = done;
+  }
+  if (fd >= 0)
+    close(fd);
+}
+
+/**
+ * @brief Run Slow Client
+ *
+ * Writes a request one byte every 100 milliseconds until the deadline,
+ * reconnecting whenever the server gives up on it (or the request is sent)
+ *
+ * @param  request   The request
+ * @param  deadline  When to stop
+ */
+void run_slow_client(const std::string& request,
+    std::chrono::steady_clock::time_point deadline) {
+  int    fd   = -1;
+  size_t sent = 0;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (fd < 0) {
+      fd   = connect_client();
+      sent = 0;
+    }
+    if (fd < 0 || send(fd, request.data() + sent, 1, MSG_NOSIGNAL) != 1) {
+      if (fd >= 0)
+        close(fd);
+      fd = -1;
+    }
+    else if (++sent == request.length()) {
+      // Start over without reading the response
+      close(fd);
+      fd = -1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  }
+  if (fd >= 0)
+    close(fd);
+}
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Runs the benchmark scenarios against a freshly started server and appends the
+# results of each scenario to a file as a line of JSON
+#
+# Usage: run.sh SERVER LOADGEN OUTPUT
+#
+# The following environment variables adjust the run:
+#   BENCH_CONNECTIONS  concurrent connections per scenario (default: 64)
+#   BENCH_DURATION     seconds per scenario (default: 5)
+#   BENCH_PORT         port the server listens on (default: 18080)
+#   BENCH_SERVER_ARGS  extra server options (default: --cache 1024 --workers 4)
+set -e
+
+server=$1
+loadgen=$2
+output=$3
+if [ -z "$server" ] || [ -z "$loadgen" ] || [ -z "$output" ]; then
+  echo "Usage: $0 SERVER LOADGEN OUTPUT" >&2
+  exit 1
+fi
+connections=${BENCH_CONNECTIONS:-64}
+duration=${BENCH_DURATION:-5}
+port=${BENCH_PORT:-18080}
+server_args=${BENCH_SERVER_ARGS:---cache 1024 --workers 4}
+
+# Build a document root with a small page and a large file
+htdocs=$(mktemp -d "${TMPDIR:-/tmp}/slwhttp-bench.XXXXXX")
+pid=
+cleanup() {
+  [ -n "$pid" ] && kill "$pid" 2>/dev/null || true
+  rm -rf "$htdocs"
+}
+trap cleanup EXIT INT TERM
+head -c 1024 /dev/zero | tr '\0' 'a' > "$htdocs/index.html"
+head -c 10485760 /dev/urandom > "$htdocs/10M.bin"
+
+# Start the server (which daemonizes) and find its process for CPU sampling
+# shellcheck disable=SC2086
+"$server" --port "$port" $server_args "$htdocs"
+sleep 1
+pid=$(pgrep -n -f -- "$htdocs" 2>/dev/null || true)
+if [ -z "$pid" ]; then
+  echo "Warning: could not find the server process; CPU time is not measured" >&2
+fi
+
+scenario() {
+  name=$1
+  shift
+  "$loadgen" --name "$name" --port "$port" --duration "$duration" \
+    --output "$output" ${pid:+--pid "$pid"} "$@"
+}
+
+scenario small-keepalive --path /index.html --connections "$connections"
+scenario small-close     --path /index.html --connections "$connections" \
+  --no-keepalive
+scenario big-file        --path /10M.bin    --connections 8
+scenario revalidate      --path /index.html --connections "$connections" \
+  --revalidate --expect 304
+scenario range           --path /10M.bin    --connections "$connections" \
+  --header "Range: bytes=1048576-1114111" --expect 206
+scenario slow-clients    --path /index.html --connections "$connections" \
+  --slow 256
+
+echo "Results were appended to $output"
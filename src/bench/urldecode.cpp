@@ -0,0 +1,112 @@
+/**
+ * @file  urldecode.cpp
+ * @brief Percent-Decoding Micro-Benchmark
+ *
+ * Checks urldecode against a naive reference decoder and measures its speed
+ * and allocations (along with those of the std::regex implementation that it
+ * replaced) on a few representative request targets
+ *
+ * Build and run it using `make microbench`
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include "bench/harness.hpp"
+#include "include/urldecode.hpp"
+
+/**
+ * @brief Reference Decode
+ *
+ * Decodes percent-escapes one character at a time, for checking urldecode
+ *
+ * @param  url    The input
+ * @param  extra  Whether or not plus characters should become spaces
+ *
+ * @return        std::string decoded input
+ */
+static std::string reference_decode(const std::string& url, bool extra) {
+  std::string out{};
+  for (size_t i = 0; i < url.length(); ++i) {
+    if (extra && url[i] == '+')
+      out += ' ';
+    else if (url[i] == '%' && i + 2 < url.length() &&
+        isxdigit(static_cast<unsigned char>(url[i + 1])) &&
+        isxdigit(static_cast<unsigned char>(url[i + 2]))) {
+      out += static_cast<char>(std::stoi(url.substr(i + 1, 2), nullptr, 16));
+      i   += 2;
+    }
+    else
+      out += url[i];
+  }
+  return out;
+}
+
+/**
+ * @brief Regex Decode
+ *
+ * The std::regex based decoder that urldecode replaced (with its plus character
+ * pattern corrected so that it can be constructed)
+ *
+ * @param  url  The input
+ *
+ * @return      std::string decoded input
+ */
+static std::string regex_decode(std::string url) {
+  const std::regex pattern{"\x25([0-9A-F]{2})", std::regex_constants::icase};
+  std::smatch match{};
+  while (std::regex_search(url, match, pattern)) {
+    char dec = static_cast<char>(strtol(match[1].str().c_str(), nullptr, 16));
+    url.replace(match.position(0), match.length(0), 1, dec);
+  }
+  return url;
+}
+
+int main() {
+  // Build a long target carrying a percent-encoded, form-style query string
+  std::string query{"/search/results.html?"};
+  for (int i = 0; i < 64; ++i)
+    query += "q%5B" + std::to_string(i) + "%5D=caf%C3%A9+au+lait%21&";
+  const struct { const char* name; std::string url; bool extra; } cases[] = {
+    {"short path",          "/index.html",                             false},
+    {"escaped path",        "/docs/My%20Files/r%C3%A9sum%C3%A9.pdf",   false},
+    {"long plain path",     "/" + std::string(2048, 'a') + ".html",    false},
+    {"long query",          query,                                     false},
+    {"long query (+)",      query,                                     true},
+    {"malformed escapes",   "/a%zz%4/b%%41%2541%",                     true}
+  };
+
+  // Check the decoder before measuring it
+  int failures = 0;
+  for (const auto& test : cases) {
+    std::string decoded{test.url};
+    urldecode(decoded, test.extra);
+    if (decoded != reference_decode(test.url, test.extra)) {
+      printf("FAIL: %s\n", test.name);
+      ++failures;
+    }
+  }
+  if (failures > 0)
+    return EXIT_FAILURE;
+
+  // Measure each case with both decoders
+  for (const auto& test : cases) {
+    std::string buffer{};
+    volatile size_t sink = 0;
+    std::string name{"urldecode: " + std::string{test.name}};
+    report(name.c_str(), measure([&]() {
+      buffer = test.url;
+      sink   = sink + urldecode(buffer, test.extra).length();
+    }));
+    name = "std::regex: " + std::string{test.name};
+    report(name.c_str(), measure([&]() {
+      sink = sink + regex_decode(test.url).length();
+    }));
+  }
+  return EXIT_SUCCESS;
+}
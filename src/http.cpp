@@ -0,0 +1,145 @@
+/**
+ * @file  http.cpp
+ * @brief HTTP Helpers
+ *
+ * Functions that build the parts of responses shared by every connection and
+ * interpret requests, kept apart from socket I/O so that they can be measured
+ * on their own
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <climits>        // for LLONG_MAX
+#include <stdexcept>      // for invalid_argument, out_of_range
+#include <string>         // for string, stoll, to_string, etc
+
+// User-level header includes
+#include "ext/Utility/Utility.hpp"
+#include "include/Request.hpp"
+#include "include/View.hpp"
+#include "include/slwhttp.hpp"
+#include "include/urldecode.hpp"
+
+/**
+ * @brief Access Denied Response
+ *
+ * Fetches the complete HTTP 403 error response, which is rendered only once so
+ * that it can be written without building a new string for every request
+ *
+ * @param  keep_alive  Whether or not the connection will persist afterwards
+ *
+ * @return             std::string response
+ */
+const std::string& access_denied_response(bool keep_alive) {
+  static const std::string message{"Access denied to the requested path.\r\n"};
+  static const std::string header{
+    "HTTP/1.1 403 Forbidden\r\n"
+    "Content-Length: " + std::to_string(message.length()) + "\r\n"
+    "Content-Type: text/plain\r\n"
+  };
+  static const std::string persistent{header + header_end(true)  + message};
+  static const std::string    closing{header + header_end(false) + message};
+  return (keep_alive ? persistent : closing);
+}
+
+/**
+ * @brief Header End
+ *
+ * Fetches the Connection header line and empty line that end every response
+ * header, depending on whether or not the connection will persist afterwards
+ *
+ * @param  keep_alive  Whether or not the connection will persist afterwards
+ *
+ * @return             std::string header lines
+ */
+const std::string& header_end(bool keep_alive) {
+  static const std::string persistent{"Connection: keep-alive\r\n\r\n"};
+  static const std::string    closing{"Connection: close\r\n\r\n"};
+  return (keep_alive ? persistent : closing);
+}
+
+/**
+ * @brief Parse Size
+ *
+ * Parses a number of bytes with an optional binary suffix ('k', 'm' or 'g')
+ *
+ * @param  str  The input string (such as "16k")
+ *
+ * @return      The number of bytes
+ */
+size_t parse_size(const std::string& str) {
+  size_t end  = 0;
+  long long size = std::stoll(str, &end);
+  std::string suffix{str.substr(end)};
+  Utility::strtolower(suffix);
+  int shift = 0;
+  if (suffix == "k")
+    shift = 10;
+  else if (suffix == "m")
+    shift = 20;
+  else if (suffix == "g")
+    shift = 30;
+  else if (suffix.length() > 0)
+    throw std::invalid_argument{"unknown size suffix \"" + suffix + "\""};
+  if (size < 0 || size > (LLONG_MAX >> shift))
+    throw std::out_of_range{"size out of range"};
+  return static_cast<size_t>(size) << shift;
+}
+
+/**
+ * @brief Request Path
+ *
+ * Determines the absolute path requested by a completed request
+ *
+ * @param[in]   request  A completed request
+ * @param[out]  path     The absolute (but not yet sandboxed) request path
+ *
+ * @return               true if the request is a "GET" request, otherwise false
+ */
+bool request_path(const Request& request, std::string& path) {
+  // Check for "GET" request
+  if (request.getMethod().iequals("get")) {
+    // Determine htdocs relative request path
+    View target = request.getTarget();
+    if (target.empty() || target.equals(View{"/", 1}))
+      // If there was no path provided, or the root was requested, serve
+      // the INDEX macro from htdocs
+      target = View{INDEX, sizeof(INDEX) - 1};
+    // Determine absolute request path, reusing the storage of the given path
+    path.assign(_htdocs);
+    path.push_back('/');
+    size_t start = path.length();
+    path.append(target.data, target.length);
+    urldecode(path, false, start);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Unavailable Response
+ *
+ * Fetches the complete HTTP 503 error response sent to clients that are turned
+ * away under load, which is rendered only once so that shedding load costs as
+ * little as possible
+ *
+ * @return  std::string response
+ */
+const std::string& unavailable_response() {
+  static const std::string message{"The server is too busy to answer the "
+    "request.\r\n"};
+  static const std::string response{
+    "HTTP/1.1 503 Service Unavailable\r\n"
+    "Content-Length: " + std::to_string(message.length()) + "\r\n"
+    "Content-Type: text/plain\r\n"
+    "Retry-After: " + std::to_string(RETRYAFTER) + "\r\n" +
+    header_end(false) + message
+  };
+  return response;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file  AccessLog.hpp
+ * @brief AccessLog
+ *
+ * Class definition for AccessLog
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _ACCESSLOG_HPP
+#define _ACCESSLOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include "include/Request.hpp"
+#include "include/Response.hpp"
+#include "include/ThreadRings.hpp"
+#include "include/Trace.hpp"
+
+// The number of formatted bytes collected before they are written
+#define ACCESSBATCH   65536
+// The number of records each thread can have waiting to be written
+#define ACCESSRECORDS 128
+// The number of bytes of request text kept for each record
+#define ACCESSTEXT    512
+
+class AccessLog {
+  public:
+    enum class Format { Common, Combined, JSON };
+    struct Record {
+      enum Field { Method, Target, Version, Referer, UserAgent, Fields };
+      int64_t      time = 0;
+      int64_t  duration = 0;
+      int64_t     bytes = 0;
+      int        status = 0;
+      uint8_t    family = 0;
+      bool       traced = false;
+      int64_t     spans[Metrics::Total];
+      uint8_t   address[16];
+      uint16_t  lengths[Fields];
+      char         text[ACCESSTEXT];
+    };
+    static bool enabled();
+    static void log(const struct sockaddr_storage& peer,
+      const Request& request, const Response& response, const Trace& trace,
+      std::chrono::steady_clock::time_point start, bool complete);
+    static void open(const std::string& path, Format format);
+    static void reopen();
+    static void start();
+    static void stop();
+  private:
+    static std::atomic<int>          fd;
+    static Format                    format;
+    static std::atomic<size_t>       lost;
+    static std::string               path;
+    static std::atomic<bool>         reopening;
+    static ThreadRings<Record, ACCESSRECORDS> rings;
+    static std::atomic<bool>         running;
+    static std::thread               writer;
+    static void append(std::string& out, const Record& record);
+    static void flush(std::string& batch);
+    static void run();
+};
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ * @file  Admission.hpp
+ * @brief Admission
+ *
+ * Class definition for Admission
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _ADMISSION_HPP
+#define _ADMISSION_HPP
+
+#include <atomic>
+
+class Admission {
+  private:
+    static std::atomic<int> clients;
+    static int              max_clients;
+    static int              max_requests;
+    static std::atomic<int> requests;
+  public:
+    static bool admit();
+    static int  connected();
+    static void finishRequest();
+    static void leave();
+    static void reject(int fd);
+    static void setLimits(int clients, int requests);
+    static bool startRequest();
+};
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file  BufferPool.hpp
+ * @brief BufferPool
+ *
+ * Class definition for BufferPool
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _BUFFERPOOL_HPP
+#define _BUFFERPOOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class BufferPool {
+  private:
+    std::vector<char*> buffers{};
+    size_t               limit = 0;
+    std::mutex           mutex{};
+    size_t                size = 0;
+  public:
+    BufferPool(size_t size, size_t limit);
+    BufferPool(const BufferPool&)            = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    ~BufferPool();
+    char*  acquire();
+    size_t getSize() const;
+    void   release(char* buffer);
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file  Connection.hpp
+ * @brief Connection
+ *
+ * Class definition for Connection
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _CONNECTION_HPP
+#define _CONNECTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "include/BufferPool.hpp"
+#include "include/IoRing.hpp"
+#include "include/Response.hpp"
+#include "include/Request.hpp"
+#include "include/Throttle.hpp"
+#include "include/Tls.hpp"
+#include "include/Trace.hpp"
+
+// Tags an io_uring operation with its client and the kind of operation
+#define RINGTAG(fd, operation) ((static_cast<uint64_t>(fd) << 8) | \
+                                static_cast<uint64_t>(operation))
+// The largest amount of a file moved through a connection's pipe at once
+#define RINGSPLICE             65536
+// The largest amount of a file sent to a client before its worker moves on to
+// its other clients
+#define SENDCHUNK              (256 << 10)
+
+class Connection {
+  public:
+    enum Operation {
+      Receive, Send, SpliceIn, SpliceOut, Resume, Operations
+    };
+  private:
+    enum class State { Handshaking, Reading, Writing, Closing };
+    std::chrono::steady_clock::time_point deadline{};
+#ifdef HAVE_LINUX_IO_URING_H
+    struct __kernel_timespec  delay{};
+#endif
+    bool             failed = false;
+    std::chrono::steady_clock::time_point    first{};
+    int                  fd = -1;
+    bool          in_flight = false;
+    struct iovec        iov[RESPONSEBUFS];
+    bool         keep_alive = false;
+    struct msghdr   message{};
+    size_t       operations = 0;
+    std::string        path{};
+    struct sockaddr_storage peer;
+    int             pipefd[2] = {-1, -1};
+    size_t            piped = 0;
+    size_t        pipe_size = 0;
+    Request         request;
+    Response       response{};
+    std::chrono::steady_clock::time_point resume{};
+    struct ssl_st*      ssl = nullptr;
+    std::chrono::steady_clock::time_point start{};
+    State             state = State::Reading;
+    Throttle       throttle{};
+    Trace             trace;
+    bool         want_write = false;
+    void finishResponse();
+    bool handshake();
+    void hold();
+    bool queueResponse();
+    bool readRequest();
+#ifdef HAVE_LINUX_IO_URING_H
+    bool splice(IoRing& ring, size_t length, bool read);
+#endif
+    bool writeResponses();
+  public:
+    Connection(int fd, BufferPool& pool, const struct sockaddr_storage& peer);
+    Connection(const Connection&)            = delete;
+    Connection& operator=(const Connection&) = delete;
+    ~Connection();
+#ifdef HAVE_LINUX_IO_URING_H
+    bool     complete(IoRing& ring, Operation operation, int result);
+#endif
+    bool     disconnect();
+    bool     expired(std::chrono::steady_clock::time_point now) const;
+    bool     handle(uint32_t events);
+    bool     idle() const;
+    uint32_t events() const;
+    std::chrono::steady_clock::time_point paused() const;
+    size_t   pending() const;
+#ifdef HAVE_LINUX_IO_URING_H
+    bool     submit(IoRing& ring);
+#endif
+};
+
+#endif
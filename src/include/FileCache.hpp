@@ -0,0 +1,124 @@
+/**
+ * @file  FileCache.hpp
+ * @brief FileCache
+ *
+ * Class definition for FileCache
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _FILECACHE_HPP
+#define _FILECACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+#include "include/Metrics.hpp"
+#include "include/ThreadSlots.hpp"
+
+// The number of independently updated shards (for each NUMA node)
+#define CACHESHARDS 16
+
+class FileCache {
+  public:
+    class Entry {
+      private:
+        std::atomic<int64_t> checked{0};
+        bool                  locked = false;
+        friend class FileCache;
+      public:
+        std::string           rpath{};
+        int                      fd = -1;
+        int64_t                size = 0;
+        struct timespec       mtime{};
+        dev_t                   dev = 0;
+        ino_t                   ino = 0;
+        std::string            etag{};
+        std::string   last_modified{};
+        std::string          fields{};
+        std::string          header{};
+        std::string    not_modified{};
+        std::string         content{};
+        bool                inlined = false;
+        std::shared_ptr<const Entry> brotli{};
+        std::shared_ptr<const Entry>   gzip{};
+        Entry() = default;
+        Entry(const Entry&)            = delete;
+        Entry& operator=(const Entry&) = delete;
+        ~Entry();
+    };
+    static size_t                       getCapacity();
+    static std::vector<int>             getNodes();
+    static void                         invalidate();
+    static void                         mapNodes();
+    static std::shared_ptr<const Entry> open(const std::string& path);
+    static void                         pin(int cpu);
+    static void                         relock();
+    static void                         setCapacity(size_t capacity);
+    static void                         setInline(size_t max, size_t budget);
+    static void                         setLocked(bool locked);
+    static void                         setPrecompressed(bool precompressed);
+    static bool                         warm(const std::string& path);
+  private:
+    struct Node {
+      std::atomic<Node*>     next{nullptr};
+      std::atomic<bool>      referenced{true};
+      std::shared_ptr<Entry> entry{};
+      size_t                 hash    = 0;
+      std::string            path{};
+      Node*                  newer   = nullptr;
+      Node*                  older   = nullptr;
+      uint64_t               retired = 0;
+    };
+    struct Reader {
+      char                  before[CACHELINE];
+      std::atomic<uint64_t> epoch{0};
+      char                  after[CACHELINE];
+    };
+    struct Shard {
+      std::atomic<std::atomic<Node*>*> buckets{nullptr};
+      size_t                           mask   = 0;
+      size_t                           bytes  = 0;
+      size_t                           count  = 0;
+      Node*                            newest = nullptr;
+      Node*                            oldest = nullptr;
+      std::vector<Node*>               retired{};
+      std::mutex                       mutex{};
+      ~Shard();
+    };
+    static size_t                capacity;
+    static std::atomic<uint64_t> epoch;
+    static size_t                inline_budget;
+    static size_t                inline_max;
+    static bool                  locked;
+    static size_t                nodes;
+    static std::vector<unsigned> placement;
+    static bool                  precompressed;
+    static ThreadSlots<Reader>   readers;
+    static Shard                 shards[][CACHESHARDS];
+    static void                   evict(Shard& shard, Node* node);
+    static Node*                  find(const Shard& shard,
+                                    const std::string& path, size_t hash);
+    static void                   forget(Shard& shard, Node* node);
+    static std::atomic<Node*>&    link(Shard& shard, const std::string& path,
+                                    size_t hash);
+    static std::shared_ptr<Entry> load(const std::string& path);
+    static std::shared_ptr<Entry> loadFile(const std::string& path);
+    static unsigned               node(int cpu);
+    static void                   reclaim(Shard& shard);
+    static void                   render(Entry& entry, const std::string& type,
+                                    const char* encoding, bool vary);
+    static bool                   revalidate(Entry& entry, int64_t now);
+    static Shard&                 shard(size_t hash);
+    static void                   store(Shard& shard, const std::string& path,
+                                    size_t hash, std::shared_ptr<Entry> entry);
+};
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file  IoRing.hpp
+ * @brief IoRing
+ *
+ * Class definition for IoRing
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _IORING_HPP
+#define _IORING_HPP
+
+// io_uring is only used where its header is available (see configure.ac)
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+// The number of submission queue entries in each ring
+#define RINGENTRIES 1024
+
+class IoRing {
+  private:
+    struct io_uring_cqe*      cqes = nullptr;
+    unsigned*              cq_head = nullptr;
+    unsigned*              cq_mask = nullptr;
+    void*                  cq_ring = nullptr;
+    size_t            cq_ring_size = 0;
+    unsigned*              cq_tail = nullptr;
+    int                         fd = -1;
+    unsigned                queued = 0;
+    unsigned*             sq_array = nullptr;
+    unsigned            sq_entries = 0;
+    unsigned*              sq_head = nullptr;
+    unsigned*              sq_mask = nullptr;
+    void*                  sq_ring = nullptr;
+    size_t            sq_ring_size = 0;
+    unsigned*              sq_tail = nullptr;
+    struct io_uring_sqe*      sqes = nullptr;
+    size_t               sqes_size = 0;
+    unsigned                  tail = 0;
+    void unmap();
+  public:
+    explicit IoRing(unsigned entries = RINGENTRIES);
+    IoRing(const IoRing&)            = delete;
+    IoRing& operator=(const IoRing&) = delete;
+    ~IoRing();
+    struct io_uring_sqe* next();
+    int                  submit(unsigned wait);
+    /**
+     * @brief Reap
+     *
+     * Passes every available completion to the given function, then marks
+     * them as consumed
+     *
+     * @param  complete  Called with each completion queue entry
+     *
+     * @return           The number of completions that were consumed
+     */
+    template <typename Complete>
+    unsigned reap(Complete complete) {
+      unsigned head  = *this->cq_head;
+      unsigned tail  = __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE);
+      unsigned count = 0;
+      for (; head != tail; ++head, ++count)
+        complete(this->cqes[head & *this->cq_mask]);
+      __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+      return count;
+    }
+};
+
+#endif
+
+#endif
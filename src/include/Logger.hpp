@@ -0,0 +1,113 @@
+/**
+ * @file  Logger.hpp
+ * @brief Logger
+ *
+ * Class definition for Logger
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _LOGGER_HPP
+#define _LOGGER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "include/ThreadRings.hpp"
+#include "include/View.hpp"
+
+// The maximum number of arguments kept for each message
+#define LOGARGS    4
+// The number of messages each thread can have waiting to be written
+#define LOGRECORDS 256
+// The maximum number of threads with a ring of their own
+#define LOGRINGS   1024
+// The number of bytes of text arguments kept for each message
+#define LOGTEXT    448
+
+class Logger {
+  public:
+    struct Record {
+      enum class Kind : uint8_t { Signed, Unsigned, Text };
+      const char* format = nullptr;
+      int         errnum = 0;
+      bool         error = false;
+      uint8_t      count = 0;
+      uint16_t      used = 0;
+      Kind         kinds[LOGARGS];
+      int64_t    numbers[LOGARGS];
+      uint16_t   lengths[LOGARGS];
+      char          text[LOGTEXT];
+    };
+    /**
+     * @brief Log
+     *
+     * Queues a message to be formatted and written by the background writer,
+     * replacing each "{}" in the format with the next argument
+     *
+     * Only the arguments are copied (text arguments are truncated to fit), so
+     * the format must be a string literal
+     *
+     * @param  error   Whether or not the description of errno is appended
+     * @param  format  The format of the message
+     * @param  args    The integer, string and View arguments of the message
+     */
+    template <typename... Args>
+    static void log(bool error, const char* format, const Args&... args) {
+      Record record;
+      record.errnum = errno;
+      record.error  = error;
+      record.format = format;
+      Logger::pack(record, args...);
+      Logger::submit(record);
+    }
+    static void start();
+    static void stop();
+  private:
+    static std::mutex                mutex;
+    static ThreadRings<Record, LOGRECORDS, LOGRINGS> rings;
+    static std::atomic<bool>         running;
+    static std::thread               writer;
+    static bool  drain();
+    static void  pack(Record&) {}
+    static void  packText(Record& record, const char* data, size_t length);
+    static void  run();
+    static void  submit(const Record& record);
+    static void  write(const Record& record);
+    template <typename T, typename... Args>
+    static typename std::enable_if<std::is_integral<T>::value>::type pack(
+        Record& record, const T& value, const Args&... args) {
+      if (record.count < LOGARGS) {
+        record.kinds[record.count]   = (std::is_signed<T>::value ?
+          Record::Kind::Signed : Record::Kind::Unsigned);
+        record.numbers[record.count] = static_cast<int64_t>(value);
+        ++record.count;
+      }
+      Logger::pack(record, args...);
+    }
+    template <typename... Args>
+    static void pack(Record& record, const char* value, const Args&... args) {
+      Logger::packText(record, value, (value != nullptr ? strlen(value) : 0));
+      Logger::pack(record, args...);
+    }
+    template <typename... Args>
+    static void pack(Record& record, const std::string& value,
+        const Args&... args) {
+      Logger::packText(record, value.data(), value.length());
+      Logger::pack(record, args...);
+    }
+    template <typename... Args>
+    static void pack(Record& record, const View& value, const Args&... args) {
+      Logger::packText(record, value.data, value.length);
+      Logger::pack(record, args...);
+    }
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file  Metrics.hpp
+ * @brief Metrics
+ *
+ * Class definition for Metrics
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _METRICS_HPP
+#define _METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "include/ThreadSlots.hpp"
+
+// The number of latency buckets (eight per power of two nanoseconds, up to
+// about eighteen minutes)
+#define METRICSBUCKETS 312
+// The size of a cache line, used to keep each thread's metrics apart
+#define CACHELINE      64
+
+class Metrics {
+  public:
+    enum Counter {
+      Accepts, CacheHits, CacheMisses, Rejects, SendfileErrors, SentBytes,
+      Status200, Status206, Status304, Status403, Status416, Status503,
+      StatusOther, Counters
+    };
+    enum Stage { HeaderRead, Resolve, FirstByte, Total, Stages };
+    static void add(Counter counter, uint64_t value = 1);
+    static bool enabled();
+    static void listen(int port, int sockfd = -1);
+    static int  listener();
+    static void record(Stage stage,
+      std::chrono::steady_clock::duration elapsed);
+    static void served(int status, int64_t bytes);
+    static void start();
+  private:
+    struct Histogram {
+      std::atomic<uint64_t> buckets[METRICSBUCKETS];
+      std::atomic<uint64_t> sum;
+    };
+    struct Slot {
+      char                  before[CACHELINE];
+      std::atomic<uint64_t> counters[Counters];
+      Histogram             histograms[Stages];
+      char                  after[CACHELINE];
+    };
+    static std::atomic<bool>  running;
+    static ThreadSlots<Slot>  slots;
+    static std::atomic<int>   sockfd;
+    static size_t      bucket(uint64_t nanoseconds);
+    static std::string render();
+    static void        run();
+    static uint64_t    upper(size_t bucket);
+};
+
+#endif
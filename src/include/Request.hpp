@@ -0,0 +1,59 @@
+/**
+ * @file  Request.hpp
+ * @brief Request
+ *
+ * Class definition for Request
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _REQUEST_HPP
+#define _REQUEST_HPP
+
+#include <cstddef>
+#include "include/BufferPool.hpp"
+#include "include/View.hpp"
+
+// The maximum size of a set of request headers (and of each pooled buffer)
+#define MAXHEADERS 16384
+// The maximum number of header fields kept from a request
+#define MAXFIELDS  64
+
+class Request {
+  private:
+    struct Field {
+      View name{};
+      View value{};
+    };
+    BufferPool&  pool;
+    char*      buffer = nullptr;
+    size_t     length = 0;
+    size_t        end = 0;
+    size_t    scanned = 0;
+    Field      fields[MAXFIELDS];
+    size_t      count = 0;
+    View       method{};
+    View       target{};
+    View      version{};
+    void parse();
+    void scan();
+  public:
+    explicit Request(BufferPool& pool);
+    Request(const Request&)            = delete;
+    Request& operator=(const Request&) = delete;
+    ~Request();
+    bool                     complete() const;
+    void                     consume();
+    View                     getMethod() const;
+    View                     getTarget() const;
+    View                     getVersion() const;
+    View                     header(const char* name) const;
+    bool                     keepAlive() const;
+    size_t                   lines(View* lines, size_t max) const;
+    bool                     overflow() const;
+    bool                     received(size_t length);
+    char*                    space(size_t& length);
+};
+
+#endif
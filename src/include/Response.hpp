@@ -0,0 +1,49 @@
+/**
+ * @file  Response.hpp
+ * @brief Response
+ *
+ * Class definition for Response
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _RESPONSE_HPP
+#define _RESPONSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/uio.h>
+#include "include/FileCache.hpp"
+#include "include/Request.hpp"
+
+// The maximum number of buffers that make up the non-file part of a response
+#define RESPONSEBUFS 4
+
+class Response {
+  private:
+    const char*        body        = nullptr;
+    size_t             body_length = 0;
+    int64_t            content     = 0;
+    const std::string* header      = nullptr;
+    const std::string* header_end  = nullptr;
+    char               prefix[192] = {};
+    size_t             prefix_length = 0;
+  public:
+    std::shared_ptr<const FileCache::Entry> file{};
+    int64_t                               length = 0;
+    int64_t                               offset = 0;
+    size_t                                  sent = 0;
+    int                                   status = 0;
+    static Response denied(bool keep_alive);
+    static Response serve(std::shared_ptr<const FileCache::Entry> file,
+      const Request& request, bool keep_alive);
+    static Response unavailable();
+    int     buffers(struct iovec* iov) const;
+    int64_t bytes() const;
+    bool    more() const;
+};
+
+#endif
@@ -12,16 +12,22 @@
 #define _SANDBOXPATH_HPP
 
 #include <string>
+#include <sys/stat.h>
 
 class SandboxPath {
   private:
+    static bool        beneath;
     static std::string jail;
+    static int         jailfd;
     std::string rpath{};
   public:
     explicit SandboxPath(const std::string& path);
     const std::string& get() const;
-    static bool checkJail(std::string path);
+    static bool checkJail(const std::string& path);
+    static int  open(const std::string& path, std::string& relative);
+    static std::string relative(const std::string& rpath);
     static bool setJail(const std::string& path);
+    static bool stat(const std::string& relative, struct stat& info);
 };
 
 #endif
@@ -0,0 +1,39 @@
+/**
+ * @file  StaticTree.hpp
+ * @brief StaticTree
+ *
+ * Class definition for StaticTree
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _STATICTREE_HPP
+#define _STATICTREE_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class StaticTree {
+  public:
+    static void build(const std::string& root);
+    static bool enabled();
+    static bool find(const std::string& path, std::string& rpath);
+    static void reload();
+    static void start();
+  private:
+    typedef std::unordered_map<std::string, std::string> Index;
+    static std::shared_ptr<const Index> index;
+    static int                          inotify;
+    static std::string                  root;
+    static std::atomic<bool>            running;
+    static int                          wakeup;
+    static void run();
+    static std::shared_ptr<const Index> scan(int& watcher);
+    static void scanDirectory(Index& index, int watcher, int dirfd,
+      const std::string& relative);
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file  ThreadRings.hpp
+ * @brief ThreadRings
+ *
+ * Class template definition and implementation for ThreadRings
+ *
+ * A ThreadRings is a set of single-producer, single-consumer rings, one per
+ * producing thread (see ThreadSlots), that are drained by a single consumer
+ * thread.  Producers never take a lock, and a producer whose ring is full drops
+ * its item instead of waiting; the number dropped is reported to the consumer
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _THREADRINGS_HPP
+#define _THREADRINGS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include "include/ThreadSlots.hpp"
+
+template <typename T, size_t Capacity, size_t MaxRings = 1024>
+class ThreadRings {
+  private:
+    struct Ring {
+      std::atomic<size_t>     head{0};
+      std::atomic<size_t>     tail{0};
+      std::atomic<size_t>  dropped{0};
+      T items[Capacity];
+    };
+    ThreadSlots<Ring, MaxRings> rings{};
+  public:
+    ThreadRings()                              = default;
+    ThreadRings(const ThreadRings&)            = delete;
+    ThreadRings& operator=(const ThreadRings&) = delete;
+    /**
+     * @brief Drain
+     *
+     * Passes every waiting item (and the number of items that were dropped
+     * from each ring) to the given functions; must only be called by the
+     * consumer thread
+     *
+     * @param  consume  Called with each waiting item
+     * @param  dropped  Called with the number of items dropped from a ring
+     *
+     * @return          true if any items were waiting, otherwise false
+     */
+    template <typename Consume, typename Dropped>
+    bool drain(Consume consume, Dropped dropped) {
+      bool waiting = false;
+      this->rings.each([&](Ring& ring) {
+        size_t tail = ring.tail.load(std::memory_order_relaxed);
+        size_t head = ring.head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+          consume(ring.items[tail % Capacity]);
+          ring.tail.store(tail + 1, std::memory_order_release);
+          waiting = true;
+        }
+        size_t lost = ring.dropped.exchange(0);
+        if (lost > 0)
+          dropped(lost);
+      });
+      return waiting;
+    }
+    /**
+     * @brief Push
+     *
+     * Copies an item into the calling thread's ring
+     *
+     * @param  fill  Called with the free slot that should receive the item
+     *
+     * @return       false if the thread has no ring (so the item should be
+     *               handled some other way), otherwise true (even if the item
+     *               was dropped because the ring was full)
+     */
+    template <typename Fill>
+    bool push(Fill fill) {
+      Ring* ring = this->rings.local();
+      if (ring == nullptr)
+        return false;
+      size_t head = ring->head.load(std::memory_order_relaxed);
+      if (head - ring->tail.load(std::memory_order_acquire) >= Capacity) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      fill(ring->items[head % Capacity]);
+      ring->head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file  ThreadSlots.hpp
+ * @brief ThreadSlots
+ *
+ * Class template definition and implementation for ThreadSlots
+ *
+ * A ThreadSlots hands each thread an object of its own without taking a lock.
+ * A thread claims its slot the first time it asks for one and gives it back
+ * when it exits, so a thread started later can reuse it instead of allocating
+ * another.  Slots are never freed, and other threads may visit every slot
+ * (e.g. to collect what each thread has written to its slot).  A thread that
+ * finds every slot in use goes without one from then on, rather than searching
+ * for a slot again each time it asks
+ *
+ * Since the claimed slot is found through a thread-local variable shared by
+ * every ThreadSlots of the same type, each type should only have one instance
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _THREADSLOTS_HPP
+#define _THREADSLOTS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t MaxSlots = 1024>
+class ThreadSlots {
+  private:
+    struct Slot {
+      std::atomic<bool> owned{false};
+      T                 value{};
+    };
+    struct Handle {
+      Slot* slot      = nullptr;
+      bool  exhausted = false;
+      ~Handle() {
+        if (this->slot != nullptr)
+          this->slot->owned.store(false, std::memory_order_release);
+      }
+    };
+    std::atomic<size_t>        count{0};
+    std::atomic<Slot*>         slots[MaxSlots];
+    static thread_local Handle handle;
+    /**
+     * @brief Acquire
+     *
+     * Claims a slot that was given up by an exited thread, or creates a new
+     * one
+     *
+     * @return  A slot owned by the calling thread, or nullptr if none are left
+     */
+    Slot* acquire() {
+      size_t limit = std::min<size_t>(this->count.load(), MaxSlots);
+      for (size_t i = 0; i < limit; ++i) {
+        Slot* slot  = this->slots[i].load(std::memory_order_acquire);
+        bool  owned = false;
+        if (slot != nullptr && slot->owned.compare_exchange_strong(owned, true,
+            std::memory_order_acquire))
+          return slot;
+      }
+      size_t index = this->count.fetch_add(1);
+      if (index >= MaxSlots)
+        return nullptr;
+      Slot* slot = new Slot{};
+      slot->owned.store(true);
+      this->slots[index].store(slot, std::memory_order_release);
+      return slot;
+    }
+  public:
+    ThreadSlots() {
+      for (std::atomic<Slot*>& slot : this->slots)
+        slot.store(nullptr);
+    }
+    ThreadSlots(const ThreadSlots&)            = delete;
+    ThreadSlots& operator=(const ThreadSlots&) = delete;
+    /**
+     * @brief Each
+     *
+     * Passes every slot that has been created (whether or not it is currently
+     * claimed) to the given function
+     *
+     * @param  visit  Called with each slot
+     */
+    template <typename Visit>
+    void each(Visit visit) {
+      size_t limit = std::min<size_t>(this->count.load(), MaxSlots);
+      for (size_t i = 0; i < limit; ++i) {
+        Slot* slot = this->slots[i].load(std::memory_order_acquire);
+        if (slot != nullptr)
+          visit(slot->value);
+      }
+    }
+    /**
+     * @brief Local
+     *
+     * Fetches the calling thread's slot, claiming one if necessary
+     *
+     * @return  The thread's slot, or nullptr if every slot was in use when the
+     *          thread first asked for one
+     */
+    T* local() {
+      if (ThreadSlots::handle.slot == nullptr &&
+          ThreadSlots::handle.exhausted == false)
+        ThreadSlots::handle.exhausted =
+          ((ThreadSlots::handle.slot = this->acquire()) == nullptr);
+      return (ThreadSlots::handle.slot != nullptr ?
+        &ThreadSlots::handle.slot->value : nullptr);
+    }
+};
+
+template <typename T, size_t MaxSlots>
+thread_local typename ThreadSlots<T, MaxSlots>::Handle
+  ThreadSlots<T, MaxSlots>::handle{};
+
+#endif
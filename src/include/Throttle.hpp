@@ -0,0 +1,50 @@
+/**
+ * @file  Throttle.hpp
+ * @brief Throttle
+ *
+ * Class definition for Throttle
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _THROTTLE_HPP
+#define _THROTTLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+class Throttle {
+  private:
+    struct Bucket {
+      std::mutex                              mutex{};
+      size_t                                   rate = 0;
+      double                                 tokens = 0;
+      std::chrono::steady_clock::time_point    last{};
+      size_t burst() const;
+      void   refill(std::chrono::steady_clock::time_point now);
+      std::chrono::steady_clock::time_point ready(
+        std::chrono::steady_clock::time_point now);
+      void   refund(size_t bytes);
+      size_t take(size_t wanted, std::chrono::steady_clock::time_point now);
+    };
+    static size_t              connection_rate;
+    static Bucket              total;
+    static std::atomic<size_t> transfers;
+    bool                       active = false;
+    Bucket                     own{};
+  public:
+    Throttle();
+    Throttle(const Throttle&)            = delete;
+    Throttle& operator=(const Throttle&) = delete;
+    ~Throttle();
+    void   finish();
+    size_t grant(size_t wanted);
+    void   refund(size_t bytes);
+    std::chrono::steady_clock::time_point resume();
+    static void setRates(size_t connection, size_t total);
+};
+
+#endif
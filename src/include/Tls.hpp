@@ -0,0 +1,46 @@
+/**
+ * @file  Tls.hpp
+ * @brief Tls
+ *
+ * Class definition for Tls
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _TLS_HPP
+#define _TLS_HPP
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// The number of TLS 1.2 sessions held by the server's session cache
+#define TLSSESSIONS 20480
+// The largest amount of a file encrypted in userspace at once (one record)
+#define TLSCHUNK    16384
+
+struct ssl_st;
+
+class Tls {
+  public:
+    enum class Result { Done, WantRead, WantWrite, Failed };
+    static struct ssl_st* accept(int fd);
+    static void           configure(const std::string& certificate,
+                            const std::string& key);
+    static bool           enabled();
+    static Result         handshake(struct ssl_st* ssl);
+    static bool           pending(struct ssl_st* ssl);
+    static ssize_t        read(struct ssl_st* ssl, int fd, char* buffer,
+                            size_t length);
+    static void           release(struct ssl_st* ssl);
+    static ssize_t        send(struct ssl_st* ssl, int fd,
+                            const struct iovec* iov, int iovcnt, bool more);
+    static ssize_t        sendfile(struct ssl_st* ssl, int out_fd, int in_fd,
+                            int64_t* offset, int64_t length);
+  private:
+    static bool kernel(struct ssl_st* ssl, bool receive);
+};
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * @file  Trace.hpp
+ * @brief Trace
+ *
+ * Class definition for Trace
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _TRACE_HPP
+#define _TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "include/Metrics.hpp"
+
+// Statically defined tracing probes (in the `slwhttp` provider) that compile
+// to a single no-op instruction each, or to nothing unless enabled
+#ifdef ENABLE_PROBES
+#include <sys/sdt.h>
+#define TRACEPOINT(name, fd, value) DTRACE_PROBE2(slwhttp, name, fd, value)
+#else
+#define TRACEPOINT(name, fd, value) do {} while (0)
+#endif
+
+class Trace {
+  private:
+    static std::atomic<size_t> count;
+    static size_t              every;
+    int                        fd = -1;
+    int64_t                    spans[Metrics::Total];
+  public:
+    static bool sample();
+    static void setSample(size_t every);
+    explicit Trace(int fd);
+    void    mark(Metrics::Stage stage,
+      std::chrono::steady_clock::duration elapsed);
+    void    reset();
+    int64_t span(Metrics::Stage stage) const;
+};
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file  View.hpp
+ * @brief View
+ *
+ * Class definition for View
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _VIEW_HPP
+#define _VIEW_HPP
+
+#include <cstddef>
+#include <string>
+
+class View {
+  public:
+    static const size_t npos = static_cast<size_t>(-1);
+    const char* data   = nullptr;
+    size_t      length = 0;
+    View() = default;
+    View(const char* data, size_t length);
+    explicit View(const std::string& str);
+    bool        empty() const;
+    bool        equals(const View& other) const;
+    bool        equals(const std::string& other) const;
+    size_t      find(char c, size_t start = 0) const;
+    bool        iequals(const char* other) const;
+    std::string str() const;
+    View        substr(size_t start, size_t count = npos) const;
+    View        trim() const;
+};
+
+#endif
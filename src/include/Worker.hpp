@@ -0,0 +1,79 @@
+/**
+ * @file  Worker.hpp
+ * @brief Worker
+ *
+ * Class definition for Worker
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _WORKER_HPP
+#define _WORKER_HPP
+
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#endif
+#include "include/BufferPool.hpp"
+#include "include/Connection.hpp"
+#include "include/IoRing.hpp"
+
+class Worker {
+  public:
+    enum class Backend { Epoll, IoUring };
+  private:
+    enum Operation { Accept = Connection::Operations, Cancel, Timer };
+    struct Client {
+      std::unique_ptr<Connection> connection{};
+      uint32_t                    events = 0;
+    };
+    BufferPool                      buffers;
+    std::unordered_map<int, Client> clients{};
+    int                                 cpu = -1;
+    int                                epfd = -1;
+#ifdef HAVE_LINUX_IO_URING_H
+    struct __kernel_timespec       interval{1, 0};
+#endif
+    bool                          listening = true;
+    bool                          multishot = true;
+#ifdef HAVE_LINUX_IO_URING_H
+    std::unique_ptr<IoRing>            ring{};
+#endif
+    int                              sockfd = -1;
+    std::thread                      thread{};
+    std::vector<int>              throttled{};
+    void acceptClients();
+    void addClient(int fd, const struct sockaddr_storage& peer);
+#ifdef HAVE_LINUX_IO_URING_H
+    void armAccept();
+    void armTimer();
+#endif
+    void closeClient(int fd);
+#ifdef HAVE_LINUX_IO_URING_H
+    void completeRing(const struct io_uring_cqe& cqe);
+#endif
+    void drain();
+    void expireClients();
+    void resumeClients();
+    void run();
+#ifdef HAVE_LINUX_IO_URING_H
+    void runRing();
+#endif
+    void updateClient(int fd, Client& client);
+  public:
+    explicit Worker(int sockfd, int cpu = -1,
+      Backend backend = Backend::Epoll);
+    Worker(const Worker&)            = delete;
+    Worker& operator=(const Worker&) = delete;
+    ~Worker();
+    void join();
+    void start();
+    static void serve(const std::vector<int>& sockfds, int count,
+      bool pin = false, Backend backend = Backend::Epoll);
+};
+
+#endif
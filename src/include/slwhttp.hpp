@@ -0,0 +1,153 @@
+/**
+ * @file  slwhttp.hpp
+ * @brief Secure Lightweight HTTP Server
+ *
+ * Function prototypes and global configuration state shared between the
+ * executable's translation units
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _SLWHTTP_HPP
+#define _SLWHTTP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <signal.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+#include "include/AccessLog.hpp"
+#include "include/Admission.hpp"
+#include "include/BufferPool.hpp"
+#include "include/FileCache.hpp"
+#include "include/Logger.hpp"
+#include "include/Request.hpp"
+#include "include/Response.hpp"
+#include "include/Throttle.hpp"
+#include "include/Tls.hpp"
+#include "include/Trace.hpp"
+#include "include/Worker.hpp"
+#include "include/urldecode.hpp"
+
+// Set the default index path (from htdocs directory)
+#define INDEX     "/index.html"
+// The number of released receive buffers each pool keeps for reuse
+#define POOLBUFS  256
+// The number of seconds a client turned away under load is asked to wait
+#define RETRYAFTER 1
+// The environment variables naming the sockets handed over during an upgrade
+#define SOCKETSENV "SLWHTTP_SOCKETS"
+#define METRICSENV "SLWHTTP_METRICS_SOCKET"
+
+// Declare function prototypes
+const std::string&       access_denied_response(bool keep_alive);
+void                     accept_clients ();
+void                     begin          ();
+bool                     dump_file      (int fd, const Response& response,
+                                         std::chrono::steady_clock::time_point
+                                           start, struct ssl_st* ssl = nullptr,
+                                         Throttle* throttle = nullptr,
+                                         Trace* trace = nullptr);
+void                     handle_signals (sigset_t signals);
+const std::string&       header_end     (bool keep_alive);
+std::vector<int>         inherited_sockets(const char* variable, int port);
+void                     iov_advance    (struct iovec*& iov, int& iovcnt,
+                                         size_t length);
+size_t                   parse_size     (const std::string& str);
+void                     prepare_client (int fd);
+int                      prepare_socket ();
+void                     print_help     (bool should_exit = true);
+void                     process_request(int fd,
+                                         const struct sockaddr_storage& peer);
+bool                     read_request   (int fd, Request& request,
+                                         Trace& trace, int timeout,
+                                         struct ssl_st* ssl = nullptr);
+std::vector<std::string> read_warm_list (const std::string& list);
+bool                     ready          (int fd, int sec = 0, int usec = 0);
+void                     reload         ();
+bool                     request_path   (const Request& request,
+                                         std::string& path);
+bool                     safe_sendfile  (int in_fd, int out_fd,
+                                         int64_t offset, int64_t data_length,
+                                         struct ssl_st* ssl = nullptr,
+                                         Throttle* throttle = nullptr);
+bool                     safe_write     (int fd, const std::string& data);
+bool                     safe_writev    (int fd, struct iovec* iov,
+                                         int iovcnt, bool more = false,
+                                         struct ssl_st* ssl = nullptr);
+const std::string&       unavailable_response();
+void                     upgrade        ();
+bool                     valid          (int fd);
+void                     warm_caches    (const std::vector<std::string>&
+                                           targets);
+
+// Declare storage for global configuration state
+extern std::string                _access_log;
+extern AccessLog::Format   _access_log_format;
+extern std::vector<std::string>         _argv;
+extern int                           _backlog;
+extern size_t                      _bandwidth;
+extern BufferPool                    _buffers;
+extern std::string                       _cwd;
+extern bool                            _debug;
+extern std::atomic<bool>            _draining;
+extern int                    _header_timeout;
+extern std::string                    _htdocs;
+extern size_t                  _inline_budget;
+extern size_t                     _inline_max;
+extern Worker::Backend            _io_backend;
+extern int                         _keepalive;
+extern int                   _max_connections;
+extern int                      _max_requests;
+extern int                      _metrics_port;
+extern bool                            _mlock;
+extern bool                              _pin;
+extern int                              _port;
+extern size_t                     _rate_limit;
+extern bool                        _reuseport;
+extern int                            _sockfd;
+extern std::vector<int>              _sockfds;
+extern bool                      _static_tree;
+extern std::string           _tls_certificate;
+extern std::string                   _tls_key;
+extern int                      _trace_sample;
+extern std::string                 _warm_list;
+extern std::vector<std::string> _warm_targets;
+extern int                           _workers;
+
+/**
+ * @brief Debug
+ *
+ * Queues a debug message for the system logger if debug mode is enabled,
+ * without formatting it on the calling thread (see Logger::log)
+ *
+ * @param  format  The format of the message
+ * @param  args    The arguments of the message
+ */
+template <typename... Args>
+void debug(const char* format, const Args&... args) {
+  if (_debug == true)
+    Logger::log(false, format, args...);
+}
+
+/**
+ * @brief Debug Error
+ *
+ * Queues a debug message for the system logger if debug mode is enabled,
+ * followed by a description of the current value of errno
+ *
+ * @param  format  The format of the message
+ * @param  args    The arguments of the message
+ */
+template <typename... Args>
+void debug_error(const char* format, const Args&... args) {
+  if (_debug == true)
+    Logger::log(true, format, args...);
+}
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ * @file  urldecode.hpp
+ * @brief Percent-Decoding
+ *
+ * Function prototype for urldecode
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#ifndef _URLDECODE_HPP
+#define _URLDECODE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Declare function prototypes
+std::string& urldecode(std::string& url, bool extra = false, size_t start = 0);
+
+#endif
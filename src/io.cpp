@@ -0,0 +1,284 @@
+/**
+ * @file  io.cpp
+ * @brief File Descriptor I/O
+ *
+ * Functions that write responses to (and wait on) client file descriptors
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <algorithm>      // for min
+#include <cerrno>         // for errno, EBADF, EINTR
+#include <climits>        // for INT_MAX
+#include <cstdint>        // for int64_t
+#include <fcntl.h>        // for fcntl, F_GETFD
+#include <netinet/in.h>   // for IPPROTO_TCP
+#include <netinet/tcp.h>  // for TCP_NODELAY
+#include <poll.h>         // for poll, pollfd, POLLIN, etc
+#include <string>         // for string
+#include <sys/sendfile.h> // for sendfile64
+#include <sys/socket.h>   // for sendmsg, setsockopt, MSG_MORE, etc
+#include <sys/types.h>    // for size_t, ssize_t
+#include <sys/uio.h>      // for iovec
+#include <thread>         // for this_thread
+#include <unistd.h>       // for write
+
+// User-level header includes
+#include "include/Metrics.hpp"
+#include "include/Response.hpp"
+#include "include/Throttle.hpp"
+#include "include/Tls.hpp"
+#include "include/Trace.hpp"
+#include "include/slwhttp.hpp"
+
+/**
+ * @brief Dump File
+ *
+ * Attempts to dump a response (and the file it refers to) to a client file
+ * descriptor
+ *
+ * @param  fd        The file descriptor to dump the file
+ * @param  response  The response to the client's request
+ * @param  start     When the request was received
+ * @param  ssl       The client's TLS session (or nullptr)
+ * @param  throttle  The client's bandwidth limits (or nullptr)
+ * @param  trace     The stages the request passes through (or nullptr)
+ *
+ * @return           true if the whole response was sent, otherwise false
+ */
+bool dump_file(int fd, const Response& response,
+    std::chrono::steady_clock::time_point start, struct ssl_st* ssl,
+    Throttle* throttle, Trace* trace) {
+  bool success = false;
+  // Ensure the output fd is valid
+  if (valid(fd)) {
+    // Emit the pre-rendered response header straight from the cache entry,
+    // along with the file itself if it is held in memory
+    struct iovec iov[RESPONSEBUFS];
+    int count = response.buffers(iov);
+    success = safe_writev(fd, iov, count, response.more(), ssl);
+    if (trace != nullptr)
+      trace->mark(Metrics::FirstByte, std::chrono::steady_clock::now() -
+        start);
+    else
+      Metrics::record(Metrics::FirstByte, std::chrono::steady_clock::now() -
+        start);
+    // Dump the requested region of the file to the client
+    if (success == true && response.more() == true) {
+      debug("attempting to send {} bytes of file to client: {}",
+        response.length, fd);
+      success = safe_sendfile(response.file->fd, fd, response.offset,
+        response.length, ssl, throttle);
+    }
+  }
+  return success;
+}
+
+/**
+ * @brief I/O Vector Advance
+ *
+ * Skips past the given number of bytes (and any empty buffers that follow them)
+ * in an array of buffers after a partial call to `writev`
+ *
+ * @param[out]  iov     The first remaining buffer
+ * @param[out]  iovcnt  The number of remaining buffers
+ * @param       length  The number of bytes that were written
+ */
+void iov_advance(struct iovec*& iov, int& iovcnt, size_t length) {
+  while (iovcnt > 0 && length >= iov->iov_len) {
+    length -= iov->iov_len;
+    ++iov;
+    --iovcnt;
+  }
+  if (iovcnt > 0) {
+    iov->iov_base  = static_cast<char*>(iov->iov_base) + length;
+    iov->iov_len  -= length;
+  }
+}
+
+/**
+ * @brief Prepare Client
+ *
+ * Configures a newly accepted client socket for sending responses
+ *
+ * Nagle's algorithm is disabled because responses are already coalesced using
+ * `MSG_MORE`, and would otherwise delay the first segment of each response on
+ * a persistent connection until the previous response was acknowledged
+ *
+ * @param  fd  The file descriptor of the associated client
+ */
+void prepare_client(int fd) {
+  int yes = 1;
+  if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(int)) < 0)
+    debug_error("failed to set socket option TCP_NODELAY");
+}
+
+/**
+ * @brief Ready
+ *
+ * Determines if a specific file descriptor is ready for reading, waiting up to
+ * the given amount of time for it to become ready
+ *
+ * @param  fd    The file descriptor to test
+ * @param  sec   The number of seconds to wait
+ * @param  usec  The number of additional microseconds to wait
+ *
+ * @return       true if ready, otherwise false
+ */
+bool ready(int fd, int sec, int usec) {
+  // Wait indefinitely if the timeout can't be represented in milliseconds
+  int timeout = -1;
+  if (sec < INT_MAX / 1000)
+    timeout = sec * 1000 + (usec + 999) / 1000;
+  // Use poll to determine status
+  struct pollfd pfd{fd, POLLIN, 0};
+  if (poll(&pfd, 1, timeout) <= 0)
+    return false;
+  // Report hang-ups and errors as readable so that read(...) can detect them
+  return (pfd.revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+}
+
+/**
+ * Safely copies a region of the given input file descriptor to the given
+ * output file descriptor
+ *
+ * The provided input file descriptor is accessed read-only for writing to the
+ * provided output file descriptor using `sendfile64` in a loop until the
+ * requested data length has been written (except in the case of an error)
+ *
+ * This function guarantees a supported size of 8EiB minus 1 byte as per the
+ * standard implementation for `int64_t` (using multiple calls to `sendfile64`)
+ *
+ * When a throttle is given, the data is sent in chunks that it grants, waiting
+ * for the bandwidth limits between them
+ *
+ * @param  in_fd        The file descriptor from which the data will be read
+ * @param  out_fd       The file descriptor to which the data will be written
+ * @param  offset       The offset of the data within the input file
+ * @param  data_length  The amount of data to write
+ * @param  ssl          The output's TLS session (or nullptr)
+ * @param  throttle     The output's bandwidth limits (or nullptr)
+ *
+ * @return              true if successful, otherwise false
+ */
+bool safe_sendfile(int in_fd, int out_fd, int64_t offset, int64_t data_length,
+    struct ssl_st* ssl, Throttle* throttle) {
+  int64_t data_end     = offset + data_length;
+  ssize_t return_val   = 1;
+  // Loop while there is data remaining and sendfile(...) makes progress
+  while (return_val > 0 && offset < data_end) {
+    int64_t length = data_end - offset;
+    if (throttle != nullptr) {
+      size_t chunk = throttle->grant(static_cast<size_t>(std::min<int64_t>(
+        length, SENDCHUNK)));
+      if (chunk == 0) {
+        std::this_thread::sleep_until(throttle->resume());
+        continue;
+      }
+      length = static_cast<int64_t>(chunk);
+    }
+    // Attempt to copy a chunk of data and advance the offset past it
+    int64_t before = offset;
+    return_val = Tls::sendfile(ssl, out_fd, in_fd, &offset, length);
+    if (throttle != nullptr)
+      throttle->refund(static_cast<size_t>(length - (offset - before)));
+  }
+  if (throttle != nullptr)
+    throttle->finish();
+  if (offset != data_end)
+    Metrics::add(Metrics::SendfileErrors);
+  return (offset == data_end);
+}
+
+/**
+ * Safely writes the given data to a file descriptor
+ *
+ * The provided data is accessed read-only for writing to the provided file
+ * descriptor using networking best practices such as looping until all data is
+ * written (except in the case of an error) and using `unsigned char` to
+ * correctly represent binary data
+ *
+ * This function guarantees a supported size of 64KiB minus 1 byte as per the
+ * standard for `size_t`, but probably supports a greater size depending on your
+ * operating system's implementation
+ *
+ * @param  fd    The file descriptor to which the data will be written
+ * @param  data  The data that should be written
+ *
+ * @return       true if successful, otherwise false
+ */
+bool safe_write(int fd, const std::string& data) {
+  const unsigned char* data_buf = reinterpret_cast<const unsigned char*>(
+                                  data.data());
+   size_t  data_length = data.length();
+   size_t  data_sent   = 0;
+  ssize_t  return_val  = 0;
+  // Loop while there is data remaining and write(...) succeeds
+  while (return_val >= 0 && data_sent < data_length) {
+    // Attempt to write a chunk of data and record the amount written
+    return_val = write(fd, data_buf + data_sent, data_length - data_sent);
+    if (return_val >= 0)
+      // Increase the data_sent count by data_written on this iteration
+      data_sent += static_cast<size_t>(return_val);
+  }
+  return (data_sent == data_length);
+}
+
+/**
+ * Safely writes the given buffers to a socket
+ *
+ * The provided buffers are written in order as if they were a single buffer
+ * using `sendmsg` in a loop until all data is written (except in the case of an
+ * error), which allows separately stored parts of a response to be sent
+ * without first copying them together
+ *
+ * When more data will immediately follow (such as a file body sent using
+ * `sendfile64`), `MSG_MORE` is used so that the kernel holds the buffers back
+ * and coalesces them with the following data into full segments instead of
+ * sending the header in a packet of its own
+ *
+ * @param  fd      The socket to which the data will be written
+ * @param  iov     The buffers that should be written (modified as data is sent)
+ * @param  iovcnt  The number of buffers
+ * @param  more    Whether or not more data will be sent immediately afterwards
+ * @param  ssl     The socket's TLS session (or nullptr)
+ *
+ * @return         true if successful, otherwise false
+ */
+bool safe_writev(int fd, struct iovec* iov, int iovcnt, bool more,
+    struct ssl_st* ssl) {
+  ssize_t return_val = 0;
+  // Skip any buffers that are already empty
+  iov_advance(iov, iovcnt, 0);
+  // Loop while there is data remaining and sendmsg(...) succeeds
+  while (return_val >= 0 && iovcnt > 0) {
+    // Attempt to write a chunk of data and skip past the amount written
+    return_val = Tls::send(ssl, fd, iov, iovcnt, more);
+    if (return_val >= 0)
+      iov_advance(iov, iovcnt, static_cast<size_t>(return_val));
+  }
+  return (iovcnt == 0);
+}
+
+/**
+ * Determines if a file descriptor is considered valid for read, write, or other
+ * input/output operations
+ *
+ * A file descriptor is considered invalid if a call requesting its flags fails
+ * with the return value of `-1` or `errno` is set to `EBADF` (the provided
+ * argument is not an open file descriptor). If neither case is satisfied, the
+ * file descriptor is considered valid
+ *
+ * @param  fd  File descriptor that should be verified
+ *
+ * @return     `true` if the file descriptor is valid, `false` otherwise
+ */
+bool valid(int fd) {
+  return (fcntl(fd, F_GETFD) != -1 || errno != EBADF);
+}
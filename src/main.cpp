@@ -15,25 +15,21 @@
  */
 
 // System-level header includes
+#include <algorithm>      // for max
+#include <atomic>         // for atomic
 #include <cassert>        // for assert
-#include <cerrno>         // for errno, EBADF
+#include <cerrno>         // for errno, EINTR
 #include <chrono>         // for seconds, duration, operator<, etc
-#include <climits>        // for INT_MAX
-#include <cstdint>        // for int64_t
-#include <cstdio>         // for perror, SEEK_END, SEEK_SET
+#include <climits>        // for PATH_MAX
 #include <cstdlib>        // for exit, EXIT_FAILURE, NULL, etc
 #include <cstring>        // for memset
-#include <fcntl.h>        // for fcntl, open, F_GETFD, O_RDONLY, etc
 #include <iostream>       // for operator<<, basic_ostream, endl, etc
-#include <mutex>          // for mutex, unique_lock
+#include <memory>         // for shared_ptr
 #include <netinet/in.h>   // for sockaddr_in, htons, INADDR_ANY, etc
 #include <pwd.h>          // for getpwnam_r, passwd
-#include <regex>          // for regex, regex_search, smatch
-#include <signal.h>       // for signal, SIGPIPE, SIG_IGN
+#include <signal.h>       // for signal, pthread_sigmask, SIGHUP, etc
 #include <stdexcept>      // for exception, runtime_error
 #include <string>         // for string, allocator, operator+, etc
-#include <sys/select.h>   // for select, FD_ISSET, FD_SET, etc
-#include <sys/sendfile.h> // for sendfile64
 #include <sys/socket.h>   // for SOL_SOCKET, AF_INET, accept, etc
 #include <sys/time.h>     // for timeval
 #include <sys/types.h>    // for size_t, ssize_t
@@ -45,35 +41,19 @@
 // User-level header includes
 #include "ext/File/File.hpp"
 #include "ext/Utility/Utility.hpp"
+#include "include/AccessLog.hpp"
+#include "include/BufferPool.hpp"
+#include "include/FileCache.hpp"
+#include "include/Logger.hpp"
+#include "include/Metrics.hpp"
+#include "include/Request.hpp"
+#include "include/Response.hpp"
 #include "include/SandboxPath.hpp"
-
-// Set the default index path (from htdocs directory)
-#define INDEX     "/index.html"
-#define BUFSIZE   8192
-
-// Declare function prototypes
-void                     access_denied  (int fd, const std::string& message);
-void                     begin          ();
-void                     debug          (const std::string& str,
-                                         bool error = false);
-void                     dump_file      (int fd, const SandboxPath& path);
-void                     prepare_socket ();
-void                     print_help     (bool should_exit = true);
-void                     process_request(int fd);
-std::vector<std::string> read_request   (int fd);
-bool                     ready          (int fd, int sec = 0, int usec = 0);
-bool                     safe_sendfile  (int in_fd, int out_fd,
-                                         int64_t data_length);
-bool                     safe_write     (int fd, const std::string& data);
-std::string&             urldecode      (std::string& url, bool extra = false);
-inline bool              valid          (int fd);
-
-// Declare storage for global configuration state
-bool         _debug = false;
-std::string _htdocs = "";
-std::mutex   _mutex = {};
-int           _port = 80;
-int         _sockfd = -1;
+#include "include/StaticTree.hpp"
+#include "include/Tls.hpp"
+#include "include/Trace.hpp"
+#include "include/Worker.hpp"
+#include "include/slwhttp.hpp"
 
 int main(int argc, const char* argv[]) {
   // General assertions for reliability
@@ -89,6 +69,12 @@ int main(int argc, const char* argv[]) {
   for (int i = 1; i < argc; ++i)
     arguments.push_back(argv[i]);
 
+  // Remember how the process was started so that it can be upgraded in place
+  _argv.assign(argv, argv + argc);
+  char cwd[PATH_MAX] = {};
+  if (getcwd(cwd, sizeof(cwd)) != nullptr)
+    _cwd = cwd;
+
   // Open a connection to the system logger for messages
   openlog(PACKAGE_NAME, LOG_NDELAY | LOG_PERROR | LOG_PID, LOG_DAEMON);
 
@@ -97,24 +83,190 @@ int main(int argc, const char* argv[]) {
     // Copy the argument from the arguments vector
     std::string option{*it};
     // Debug the option being processed
-    debug("processing option: " + option);
+    debug("processing option: {}", option);
     // Lowercase the text in the option variable
     Utility::strtolower(option);
     // Check if the given item is a valid option
-    if (option == "--debug") {
+    if (option == "--access-log") {
+      if (it + 1 != arguments.end()) {
+        _access_log = *(++it);
+        debug("_access_log = {}", _access_log);
+      }
+      else {
+        std::cerr << "Error: no access log path was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--access-log-format") {
+      std::string format{};
+      if (it + 1 != arguments.end())
+        format = *(++it);
+      Utility::strtolower(format);
+      if (format == "common")
+        _access_log_format = AccessLog::Format::Common;
+      else if (format == "combined")
+        _access_log_format = AccessLog::Format::Combined;
+      else if (format == "json")
+        _access_log_format = AccessLog::Format::JSON;
+      else {
+        std::cerr << "Error: the access log format must be common, combined "
+          "or json" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      debug("_access_log_format = {}", format);
+    }
+    else if (option == "--backlog" || option == "--header-timeout" ||
+        option == "--max-connections" || option == "--max-requests" ||
+        option == "--trace-sample") {
+      if (it + 1 != arguments.end()) {
+        try {
+          int value = std::stoi(*(++it));
+          // Only the limits and trace sampling can be disabled
+          if (value < 0 || (value == 0 && (option == "--backlog" ||
+              option == "--header-timeout")))
+            throw std::out_of_range{"invalid limit"};
+          if (option == "--backlog")
+            _backlog         = value;
+          else if (option == "--header-timeout")
+            _header_timeout  = value;
+          else if (option == "--max-connections")
+            _max_connections = value;
+          else if (option == "--max-requests")
+            _max_requests    = value;
+          else
+            _trace_sample    = value;
+          debug("{} = {}", View{option}.substr(2), value);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided number is not valid" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no number was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--debug") {
       _debug = true;
       debug("all debug messages can be found in the syslog");
-      debug("running in debug mode will reduce performance");
+      debug("debug messages are written by a background thread");
+    }
+    else if (option == "--cache") {
+      if (it + 1 != arguments.end()) {
+        try {
+          int capacity = std::stoi(*(++it));
+          if (capacity < 0)
+            throw std::out_of_range{"negative cache capacity"};
+          FileCache::setCapacity(static_cast<size_t>(capacity));
+          debug("cache capacity = {}", capacity);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided cache capacity is not a valid "
+            "number" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no cache capacity was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
     }
     else if (option == "--help")
       print_help();
+    else if (option == "--bandwidth" || option == "--inline-budget" ||
+        option == "--inline-max" || option == "--rate-limit") {
+      if (it + 1 != arguments.end()) {
+        try {
+          size_t size = parse_size(*(++it));
+          if (option == "--bandwidth")
+            _bandwidth     = size;
+          else if (option == "--inline-max")
+            _inline_max    = size;
+          else if (option == "--rate-limit")
+            _rate_limit    = size;
+          else
+            _inline_budget = size;
+          debug("{} = {}", View{option}.substr(2), size);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided size is not valid" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no size was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--io-backend") {
+      std::string backend{};
+      if (it + 1 != arguments.end())
+        backend = *(++it);
+      Utility::strtolower(backend);
+      if (backend == "epoll")
+        _io_backend = Worker::Backend::Epoll;
+#ifdef HAVE_LINUX_IO_URING_H
+      else if (backend == "io_uring")
+        _io_backend = Worker::Backend::IoUring;
+#else
+      else if (backend == "io_uring") {
+        std::cerr << "Error: " << PACKAGE_NAME << " was built without io_uring"
+          " support" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+#endif
+      else {
+        std::cerr << "Error: the I/O backend must be epoll or io_uring"
+          << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      debug("_io_backend = {}", backend);
+    }
+    else if (option == "--keepalive") {
+      if (it + 1 != arguments.end()) {
+        try {
+          _keepalive = std::stoi(*(++it));
+          if (_keepalive < 0)
+            throw std::out_of_range{"negative idle timeout"};
+          debug("_keepalive = {}", _keepalive);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided idle timeout is not a valid "
+            "number" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no idle timeout was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--metrics-port") {
+      if (it + 1 != arguments.end()) {
+        try {
+          _metrics_port = std::stoi(*(++it));
+          if (_metrics_port <= 0 || _metrics_port > 65535)
+            throw std::out_of_range{"invalid port"};
+          debug("_metrics_port = {}", _metrics_port);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided metrics port is not valid"
+            << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no metrics port was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--mlock")
+      _mlock = true;
+    else if (option == "--pin")
+      _pin = true;
     else if (option == "--port") {
       if (it + 1 != arguments.end()) {
         try {
           // NOTE: cppcheck complains that it + 1 is not checked for equality
           //       against arguments.end(), but that check is three lines up...
           _port = std::stoi(*(++it));
-          debug("_port = " + std::to_string(_port));
+          debug("_port = {}", _port);
         } catch (const std::exception& e) {
           std::cerr << "Error: the provided port is not numeric" << std::endl;
           exit(EXIT_FAILURE);
@@ -125,11 +277,66 @@ int main(int argc, const char* argv[]) {
         exit(EXIT_FAILURE);
       }
     }
+    else if (option == "--precompressed")
+      FileCache::setPrecompressed(true);
+    else if (option == "--reuseport")
+      _reuseport = true;
+    else if (option == "--static-tree")
+      _static_tree = true;
+    else if (option == "--tls-certificate") {
+      if (it + 1 != arguments.end()) {
+        _tls_certificate = *(++it);
+        debug("_tls_certificate = {}", _tls_certificate);
+      }
+      else {
+        std::cerr << "Error: no TLS certificate path was provided"
+          << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--tls-key") {
+      if (it + 1 != arguments.end()) {
+        _tls_key = *(++it);
+        debug("_tls_key = {}", _tls_key);
+      }
+      else {
+        std::cerr << "Error: no TLS key path was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--warm") {
+      if (it + 1 != arguments.end()) {
+        _warm_list = *(++it);
+        debug("_warm_list = {}", _warm_list);
+      }
+      else {
+        std::cerr << "Error: no warm-up list was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--workers") {
+      if (it + 1 != arguments.end()) {
+        try {
+          _workers = std::stoi(*(++it));
+          if (_workers < 0)
+            throw std::out_of_range{"negative worker count"};
+          debug("_workers = {}", _workers);
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided worker count is not a valid "
+            "number" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no worker count was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
     else if (_htdocs.length() == 0) {
       const std::string rpath = File::realPath(*it);
       if (File::isDirectory(rpath) && File::executable(rpath)) {
         _htdocs = rpath;
-        debug("_htdocs = " + _htdocs);
+        debug("_htdocs = {}", _htdocs);
       }
       else {
         std::cerr << "Error: could not traverse htdocs path" << std::endl;
@@ -144,49 +351,117 @@ int main(int argc, const char* argv[]) {
     exit(EXIT_FAILURE);
   }
 
+  // Run one worker per CPU unless told otherwise when a worker-only option is
+  // used without an explicit worker count
+  if ((_reuseport == true || _pin == true ||
+      _io_backend == Worker::Backend::IoUring) && _workers == 0) {
+    _workers = std::max(1u, std::thread::hardware_concurrency());
+    debug("_workers = {}", _workers);
+  }
+
+  // Open the access log while it can still be created with full privileges
+  if (_access_log.length() > 0) {
+    try {
+      AccessLog::open(_access_log, _access_log_format);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Load the TLS certificate and key while they can still be read with full
+  // privileges
+  if (_tls_certificate.length() > 0 || _tls_key.length() > 0) {
+    try {
+      Tls::configure(_tls_certificate, (_tls_key.length() > 0 ? _tls_key :
+        _tls_certificate));
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Read the files to warm the cache with while the list can still be read
+  // with full privileges (there is nothing to warm without a cache)
+  if (_warm_list.length() > 0) {
+    if (FileCache::getCapacity() == 0) {
+      std::cerr << "Error: --warm requires a non-zero --cache" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    try {
+      _warm_targets = read_warm_list(_warm_list);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // Divide the file cache between the NUMA nodes the process may run on, then
+  // configure which cached files are held (and locked) in memory, raising the
+  // locked memory limit while it can still be raised
+  FileCache::mapNodes();
+  FileCache::setInline(_inline_max, _inline_budget);
+  FileCache::setLocked(_mlock);
+
+  // Configure how quickly file content may be sent
+  Throttle::setRates(_rate_limit, _bandwidth);
+
+  // Configure how many clients and requests are taken on before shedding load
+  Admission::setLimits(_max_connections, _max_requests);
+
+  // Configure how often the stages of a request are written to the access log
+  Trace::setSample(static_cast<size_t>(_trace_sample));
+
   // Set the jail path for SandboxPath objects
   SandboxPath::setJail(_htdocs);
 
+  // Index every file in the jail up front if it won't change often
+  if (_static_tree == true) {
+    try {
+      StaticTree::build(_htdocs);
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // Begin listening for connections
   try {
     begin();
   } catch (const std::exception& e) {
-    debug(e.what());
+    debug("{}", e.what());
     exit(EXIT_FAILURE);
   }
 
   return 0;
 }
 
-/**
- * @brief Access Denied
- *
- * Writes a HTTP/1.0 403 error to the given client
- *
- * @param  fd  The file descriptor of the associated client
- */
-void access_denied(int fd, const std::string& message) {
-  if (valid(fd)) {
-    // Build the response variable
-    std::string response{
-      "HTTP/1.0 403 Forbidden\r\n"
-      "Content-Length: " + std::to_string(message.length()) + "\r\n"
-      "\r\n" +
-      message
-    };
-    // Write response to client
-    safe_write(fd, response);
-  }
-}
-
 /**
  * @brief Begin
  *
  * Begin listening for connections
  */
 void begin() {
+  // Take over the listening sockets of the process being upgraded (if any) so
+  // that no client is refused while it is replaced
+  std::vector<int>& sockfds = _sockfds;
+  sockfds = inherited_sockets(SOCKETSENV, _port);
+  size_t needed = (_reuseport == true ? static_cast<size_t>(std::max(1,
+    _workers)) : 1);
+  for (; sockfds.size() > needed; sockfds.pop_back())
+    close(sockfds.back());
   // Prepare the listening socket in order to accept connections
-  prepare_socket();
+  if (sockfds.empty())
+    sockfds.push_back(prepare_socket());
+  _sockfd = sockfds[0];
+  // Give every worker its own listening socket if requested (these must all
+  // be bound before privileges are dropped)
+  while (sockfds.size() < needed)
+    sockfds.push_back(prepare_socket());
+  // Prepare the admin port for metrics if requested
+  std::vector<int> metrics = inherited_sockets(METRICSENV, _metrics_port);
+  if (_metrics_port > 0)
+    Metrics::listen(_metrics_port, (metrics.empty() ? -1 : metrics[0]));
 
 #ifdef ENABLE_SETUID
   // Set the effective user/group ID to "nobody"
@@ -212,93 +487,110 @@ void begin() {
   debug("now running with reduced privileges of 'nobody' account");
 #endif
 
+  // Load the expected files before the first client arrives (while the process
+  // being upgraded, if any, keeps serving)
+  if (_warm_targets.empty() == false)
+    warm_caches(_warm_targets);
+
   // Drop to a daemon process
   if (daemon(0, 0) != 0) {
-    debug("couldn't daemonize", true);
+    debug_error("couldn't daemonize");
     exit(EXIT_FAILURE);
   }
 
-  // Loop indefinitely to accept and process clients
-  debug("begin accepting clients securely");
-  while (valid(_sockfd)) {
-    // Stall for incoming connections or data
-    ready(_sockfd, INT_MAX);
-    // If the listening socket is marked as read available, client incoming
-    int clifd = accept(_sockfd, NULL, NULL);
-    // Check if the client descriptor is valid
-    if (valid(clifd)) {
-      debug("accepted client: " + std::to_string(clifd));
-      // Process the request
-      std::thread(process_request, clifd).detach();
-    }
-    else debug("error accepting client", true);
-  }
-}
-
-/**
- * @brief Debug
- *
- * Prints debug information if debug mode is enabled
- *
- * @param  str    The input string
- * @param  error  Whether or not this call should print using perror(...)
- */
-void debug(const std::string& str, bool error) {
-  // Check if debug mode is enabled
-  if (_debug == true) {
-    std::unique_lock<std::mutex> lock{_mutex};
-    if (error == true)
-      // Print the given message with the appropriate error string
-      syslog(LOG_DEBUG, "%s: %s", str.c_str(), strerror(errno));
-    else
-      // Print the given message
-      syslog(LOG_DEBUG, "%s",     str.c_str());
+  // Lock the warmed files in memory again, since the daemon didn't inherit the
+  // locks
+  if (_mlock == true)
+    FileCache::relock();
+
+  // Reload on SIGHUP and upgrade on SIGUSR2 from a thread of their own (the
+  // signals must be blocked in every other thread, so this comes first)
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGHUP);
+  sigaddset(&signals, SIGUSR2);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+  std::thread{handle_signals, signals}.detach();
+
+  // Write debug messages from a background thread from now on
+  if (_debug == true)
+    Logger::start();
+
+  // Write the access log from a background thread (reopened on SIGHUP so that
+  // it can be rotated)
+  if (AccessLog::enabled())
+    AccessLog::start();
+
+  // Serve metrics from a background thread
+  Metrics::start();
+
+  // Keep the static tree index current from a background thread
+  if (StaticTree::enabled())
+    StaticTree::start();
+
+  // Hand the listening socket to a fixed pool of event loops if requested
+  if (_workers > 0)
+    Worker::serve(sockfds, _workers, _pin, _io_backend);
+  else
+    accept_clients();
+
+  // Exit once the listening sockets have been handed to a new process and the
+  // last client is gone
+  if (_draining.load() == true) {
+    while (Admission::connected() > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    debug("drained all clients, exiting");
+    AccessLog::stop();
+    Logger::stop();
+    _exit(EXIT_SUCCESS);
   }
 }
 
 /**
- * @brief Dump File
- *
- * Attempts to dump a file to a client file descriptor
+ * @brief Accept Clients
  *
- * @param  path  A SanboxPath to the file to dump
- * @param  fd    The file descriptor to dump the file
+ * Accepts clients from the listening socket, answering each one from a thread
+ * of its own, until the socket is handed to a new process
  */
-void dump_file(int fd, const SandboxPath& path) {
-  // Ensure the output fd is valid
-  if (valid(fd)) {
-    // Open file for reading
-    int file = open(path.get().c_str(), O_RDONLY);
-    // Ensure the file was successfully opened and is in good condition
-    if (valid(file)) {
-      // Calculate the file size
-      int64_t fsize = lseek64(file, 0, SEEK_END);
-      if (fsize >= 0 && lseek64(file, 0, SEEK_SET) >= 0) {
-        // Write response to client
-        const std::string response{
-          "HTTP/1.0 200 OK\r\n"
-          "Content-Length: " + std::to_string(fsize) + "\r\n"
-          "\r\n"
-        };
-
-        // Dump the response to the client
-        debug("attempting to send " + std::to_string(fsize) + " byte file to "
-          "client: " + std::to_string(fd));
-        safe_write(fd, response);
-        safe_sendfile(file, fd, fsize);
+void accept_clients() {
+  debug("begin accepting clients securely");
+  while (valid(_sockfd) && _draining.load() == false) {
+    // Stall for incoming connections or data (waking every second to check if
+    // the socket was handed to a new process)
+    if (ready(_sockfd, 1) == false)
+      continue;
+    // If the listening socket is marked as read available, client incoming
+    struct sockaddr_storage peer{};
+    socklen_t length = sizeof(peer);
+    int clifd = accept(_sockfd, reinterpret_cast<struct sockaddr*>(&peer),
+      &length);
+    // Check if the client descriptor is valid
+    if (valid(clifd)) {
+      debug("accepted client: {}", clifd);
+      Metrics::add(Metrics::Accepts);
+      TRACEPOINT(accept, clifd, Admission::connected());
+      // Turn the client away before starting a thread for it if too many are
+      // already connected
+      if (Admission::admit() == false) {
+        Admission::reject(clifd);
+        continue;
       }
+      prepare_client(clifd);
+      // Process the request
+      std::thread(process_request, clifd, peer).detach();
     }
-    // Close the source file
-    close(file);
+    else debug_error("error accepting client");
   }
 }
 
 /**
  * @brief Prepare Socket
  *
- * Prepares the listening socket for accepting incoming connections
+ * Prepares a listening socket for accepting incoming connections
+ *
+ * @return  The file descriptor of the listening socket
  */
-void prepare_socket() {
+int prepare_socket() {
   // Prepare the bind address information
   struct sockaddr_in serv_addr;
   memset(&serv_addr, 0, sizeof(serv_addr));
@@ -307,34 +599,40 @@ void prepare_socket() {
   serv_addr.sin_port        = htons(_port);
 
   // Setup the listening socket
-  _sockfd = socket(AF_INET, SOCK_STREAM, 0);
-  if (_sockfd < 0)
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (sockfd < 0)
     throw std::runtime_error{"failed to create socket"};
   // Attempt to reuse the listen address if already (or was) in use
   int yes = 1;
-  if (setsockopt(_sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0)
+  if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int)) < 0)
     throw std::runtime_error{"failed to set socket option SO_REUSEADDR"};
+  // Allow one listening socket per worker to share the listen address so that
+  // the kernel distributes incoming connections between them
+  if (_reuseport == true &&
+      setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(int)) < 0)
+    throw std::runtime_error{"failed to set socket option SO_REUSEPORT"};
   struct timeval timeout{3, 0};
-  if (setsockopt(_sockfd, SOL_SOCKET, SO_RCVTIMEO, (void*)&timeout,
+  if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, (void*)&timeout,
       sizeof(struct timeval)) < 0)
     throw std::runtime_error{"failed to set socket option SO_RCVTIMEO"};
-  if (setsockopt(_sockfd, SOL_SOCKET, SO_SNDTIMEO, (void*)&timeout,
+  if (setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, (void*)&timeout,
       sizeof(struct timeval)) < 0)
     throw std::runtime_error{"failed to set socket option SO_SNDTIMEO"};
   // Attempt to bind to the listen address
-  if (bind(_sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
-    close(_sockfd);
+  if (bind(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
+    close(sockfd);
     throw std::runtime_error{"failed to bind to 0.0.0.0:" +
       std::to_string(_port)};
   }
   else {
-    // Listen with a backlog of 256
-    if (listen(_sockfd, 256) < 0) {
-      close(_sockfd);
+    // Listen with the configured backlog
+    if (listen(sockfd, _backlog) < 0) {
+      close(sockfd);
       throw std::runtime_error{"failed to listen on socket"};
     }
-    debug("listening on 0.0.0.0:" + std::to_string(_port));
+    debug("listening on 0.0.0.0:{}", _port);
   }
+  return sockfd;
 }
 
 /**
@@ -350,14 +648,156 @@ void print_help(bool should_exit) {
             << "Serves static content (securely) from a given directory."
             << std::endl << std::endl
             << "Command line options:" << std::endl
+            << "  --access-log" << std::endl
+            << "             append a line for every response to PATH,"
+            << std::endl
+            << "             reopening it on SIGHUP" << std::endl
+            << "  --access-log-format" << std::endl
+            << "             common, combined or json (default: common)"
+            << std::endl
+            << "  --backlog  queue up to N clients waiting to be accepted"
+            << std::endl
+            << "             (default: 256)" << std::endl
+            << "  --bandwidth" << std::endl
+            << "             send files to all clients together at no more"
+            << std::endl
+            << "             than SIZE (e.g. 100m) bytes per second"
+            << std::endl
+            << "  --cache    keep up to N resolved, open files in memory,"
+            << std::endl
+            << "             rechecking each once per second (default: 0)"
+            << std::endl
             << "  --debug    enable debug mode" << std::endl
+            << "  --header-timeout" << std::endl
+            << "             seconds a new client has to send its request"
+            << std::endl
+            << "             headers (default: 3)" << std::endl
             << "  --help     display this help and exit" << std::endl
+            << "  --inline-max"
+            << std::endl
+            << "             hold cached files up to SIZE (e.g. 16k) in memory"
+            << std::endl
+            << "             and send them along with their header"
+            << std::endl
+            << "             (default: 0, always use sendfile)" << std::endl
+            << "  --inline-budget"
+            << std::endl
+            << "             total SIZE of files held in memory (default: 64m)"
+            << std::endl
+            << "  --io-backend" << std::endl
+            << "             epoll or io_uring, used by the worker threads"
+            << std::endl
+            << "             (default: epoll, io_uring falls back to epoll"
+            << std::endl
+            << "             where the kernel doesn't support it)" << std::endl
+            << "  --keepalive"
+            << std::endl
+            << "             seconds to keep idle HTTP/1.1 connections open"
+            << std::endl
+            << "             (default: 5, 0 closes after every response)"
+            << std::endl
+            << "  --max-connections" << std::endl
+            << "             answer further clients with 503 Service"
+            << std::endl
+            << "             Unavailable once N are connected (default: 0,"
+            << std::endl
+            << "             unlimited)" << std::endl
+            << "  --max-requests" << std::endl
+            << "             answer requests with 503 Service Unavailable once"
+            << std::endl
+            << "             N are being answered (default: 0, unlimited)"
+            << std::endl
+            << "  --metrics-port" << std::endl
+            << "             serve counters and latency percentiles at"
+            << std::endl
+            << "             http://127.0.0.1:PORT/metrics in the Prometheus"
+            << std::endl
+            << "             text format" << std::endl
+            << "  --mlock    lock files held in memory so they are never paged"
+            << std::endl
+            << "             out" << std::endl
+            << "  --pin      pin each worker thread to its own CPU" << std::endl
             << "  --port     set the listen port (default: 80)" << std::endl
+            << "  --precompressed" << std::endl
+            << "             serve FILE.br or FILE.gz in place of FILE to"
+            << std::endl
+            << "             clients that accept that Content-Encoding"
+            << std::endl
+            << "  --rate-limit" << std::endl
+            << "             send files to each client at no more than SIZE"
+            << std::endl
+            << "             bytes per second" << std::endl
+            << "  --reuseport" << std::endl
+            << "             give each worker its own SO_REUSEPORT listening"
+            << std::endl
+            << "             socket so the kernel spreads clients across them"
+            << std::endl
+            << "  --static-tree" << std::endl
+            << "             index every file in htdocs at startup (and again"
+            << std::endl
+            << "             whenever it changes) so that request paths are"
+            << std::endl
+            << "             resolved without any system calls" << std::endl
+            << "  --tls-certificate" << std::endl
+            << "             serve HTTPS using the PEM certificate chain at"
+            << std::endl
+            << "             PATH, handing the session to kernel TLS where"
+            << std::endl
+            << "             supported so files are still sent with sendfile"
+            << std::endl
+            << "  --tls-key  the PEM private key at PATH (default: read from"
+            << std::endl
+            << "             the certificate file)" << std::endl
+            << "  --trace-sample" << std::endl
+            << "             add the time taken to read, resolve and start"
+            << std::endl
+            << "             answering one in every N requests to the access"
+            << std::endl
+            << "             log (default: 0, never)" << std::endl
+            << "  --warm     load the paths listed one per line in FILE (or"
+            << std::endl
+            << "             the most requested paths in an access log) into"
+            << std::endl
+            << "             the cache (see --cache) before accepting clients"
+            << std::endl
+            << "  --workers  serve clients from a fixed pool of N event-loop"
+            << std::endl
+            << "             threads instead of one thread per client"
+            << std::endl << std::endl
+            << "Signals:" << std::endl
+            << "  SIGHUP     reopen the access log, recheck each cached file"
+            << std::endl
+            << "             and rescan the static tree" << std::endl
+            << "  SIGUSR2    start a new copy of the executable that takes over"
+            << std::endl
+            << "             the listening sockets, then exit once every client"
+            << std::endl
+            << "             of this process has been served" << std::endl
             << std::endl
             << "Examples:" << std::endl
             << "  " << PACKAGE_NAME << " --port 8080 /var/www" << std::endl
             << "  " << PACKAGE_NAME << " --help" << std::endl
             << "  " << PACKAGE_NAME << " --debug /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --workers 4 /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --reuseport --pin /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --io-backend io_uring /var/www"
+            << std::endl
+            << "  " << PACKAGE_NAME << " --cache 4096 --inline-max 16k /var/www"
+            << std::endl
+            << "  " << PACKAGE_NAME << " --cache 4096 --precompressed /var/www"
+            << std::endl
+            << "  " << PACKAGE_NAME << " --static-tree --workers 4 /var/www"
+            << std::endl
+            << "  " << PACKAGE_NAME << " --port 443 --tls-certificate cert.pem"
+            << " --tls-key key.pem /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --access-log /var/log/slwhttp.log"
+            << " /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --max-connections 10000 --backlog 4096"
+            << " /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --workers 4 --rate-limit 1m"
+            << " --bandwidth 100m /var/www" << std::endl
+            << "  " << PACKAGE_NAME << " --cache 4096 --warm"
+            << " /var/log/slwhttp.log /var/www" << std::endl
             << std::endl
             << PACKAGE_NAME << "-" << PACKAGE_VERSION << " online help: <"
             << PACKAGE_URL << ">"
@@ -369,259 +809,158 @@ void print_help(bool should_exit) {
 /**
  * @brief Process Request
  *
- * Takes a file descriptor and fetches a std::string request and processes the
- * text as the HTTP protocol
+ * Takes a file descriptor and answers each request read from it, in order,
+ * until the client no longer wishes to keep the connection alive
  *
- * @param  fd  The file descriptor of the associated client
+ * @param  fd    The file descriptor of the associated client
+ * @param  peer  The address of the client
  */
-void process_request(int fd) {
+void process_request(int fd, const struct sockaddr_storage& peer) {
   // Ensure that the provided fd is valid
   if (valid(fd)) {
-    debug("process_request(" + std::to_string(fd) + ")");
-    // Read the request headers provided by the client
-    std::vector<std::string> request = read_request(fd);
-    if (_debug == true) {
-      debug("request content (from fd: " + std::to_string(fd) + "):");
-      bool first = true;
-      for (const std::string& line : request)
-        if (first == true) {
-          first = false;
-          debug(" -> " + line);
-        }
-        else
-          debug("    " + line);
+    debug("process_request({})", fd);
+    // Hold everything this connection's requests need for reuse between them
+    Request     request{_buffers};
+    Response    response{};
+    std::string _rpath{};
+    Throttle    throttle{};
+    Trace       trace{fd};
+    // Allow the client a limited amount of time to send its first request,
+    // then the idle timeout between each following request
+    int timeout = _header_timeout;
+    // Complete the TLS handshake (if enabled) within the same amount of time,
+    // which also bounds how long each following record may take to arrive
+    struct ssl_st* ssl = nullptr;
+    bool open = true;
+    if (Tls::enabled()) {
+      struct timeval limit{timeout, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+      ssl  = Tls::accept(fd);
+      open = (ssl != nullptr && Tls::handshake(ssl) == Tls::Result::Done);
     }
-    // Check for GET request
-    for (std::string line : request) {
-      // Explode the line into words
-      std::vector<std::string> words = Utility::explode(
-        Utility::trim(line), " ");
-      // Check for "GET" request
-      if (words.size() > 0 && Utility::strtolower(words[0]) == "get") {
-        // Determine htdocs relative request path
-        std::string _rpath{};
-        if (words.size() == 1 || Utility::trim(words[1]) == "/")
-          // If there was no path provided, or the root was requested, serve
-          // the INDEX macro from htdocs
-          _rpath = INDEX;
-        else
-          // If a non-redirectable path was provided, use it
-          _rpath = words[1];
-
+    // Read the request headers provided by the client
+    while (open == true && read_request(fd, request, trace, timeout, ssl)) {
+      auto start = std::chrono::steady_clock::now();
+      if (_debug == true) {
+        debug("request content (from fd: {}):", fd);
+        View lines[MAXFIELDS + 1];
+        size_t count = request.lines(lines, MAXFIELDS + 1);
+        for (size_t i = 0; i < count; ++i)
+          debug((i == 0 ? " -> {}" : "    {}"), lines[i]);
+      }
+      // Stop keeping connections alive once the listening socket has been
+      // handed to a new process, so that clients reconnect to it
+      bool keep_alive = (_keepalive > 0 && request.keepAlive() &&
+        _draining.load() == false);
+      // Check for GET request and determine absolute request path
+      if (request_path(request, _rpath) == false)
+        break;
+      // Turn the request away if too many are already being answered
+      bool admitted = Admission::startRequest();
+      if (admitted == false) {
+        keep_alive = false;
+        response   = Response::unavailable();
+      }
+      else {
         try {
-          // Determine absolute request path
-          _rpath = _htdocs + "/" + urldecode(_rpath);
-          debug("raw request for path: " + _rpath);
-          SandboxPath path{_rpath};
-          debug("sandboxed request for real path (from fd: " +
-            std::to_string(fd) + "): " + path.get());
-          // Attempt to dump the file to the client
-          dump_file(fd, path);
+          debug("raw request for path: {}", _rpath);
+          std::shared_ptr<const FileCache::Entry> file =
+            FileCache::open(_rpath);
+          trace.mark(Metrics::Resolve, std::chrono::steady_clock::now() -
+            start);
+          debug("sandboxed request for real path (from fd: {}): {}", fd,
+            file->rpath);
+          response = Response::serve(file, request, keep_alive);
         } catch (const std::exception& e) {
-          access_denied(fd, "Access denied to the requested path.\r\n");
-          debug(e.what());
+          trace.mark(Metrics::Resolve, std::chrono::steady_clock::now() -
+            start);
+          response = Response::denied(keep_alive);
+          debug("{}", e.what());
         }
       }
+      // Attempt to dump the file to the client
+      bool sent = dump_file(fd, response, start, ssl, &throttle, &trace);
+      if (admitted == true)
+        Admission::finishRequest();
+      Metrics::served(response.status, (sent ? response.bytes() : 0));
+      if (sent == true)
+        trace.mark(Metrics::Total, std::chrono::steady_clock::now() - start);
+      AccessLog::log(peer, request, response, trace, start, sent);
+      if (sent == false)
+        break;
+      if (keep_alive == false)
+        break;
+      // Release the file and move on to the next (possibly already received)
+      // request
+      response = Response{};
+      request.consume();
+      trace.reset();
+      timeout = _keepalive;
     }
 
     // Close the file descriptor
+    Tls::release(ssl);
     shutdown(fd, SHUT_RDWR);
     close(fd);
     // Remove the file descriptor from the client set
-    debug("disconnect fd: " + std::to_string(fd));
+    debug("disconnect fd: {}", fd);
   }
+  Admission::leave();
 }
 
 /**
  * @brief Read Request
  *
- * Reads HTTP/1.0 request headers from the given client
+ * Reads HTTP request headers from the given client unless a complete request
+ * was already received along with the previous one
  *
- * @param  fd  The file descriptor of the associated client
+ * @param  fd       The file descriptor of the associated client
+ * @param  request  The request that should receive the headers
+ * @param  trace    The stages the request passes through
+ * @param  timeout  The number of seconds allowed to receive the headers
+ * @param  ssl      The client's TLS session (or nullptr)
  *
- * @return     std::vector of request header lines
+ * @return          true if the request headers are complete, otherwise false
  */
-std::vector<std::string> read_request(int fd) {
-  std::string request{};
+bool read_request(int fd, Request& request, Trace& trace, int timeout,
+    struct ssl_st* ssl) {
+  auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::seconds{timeout};
+  // Note when the first part of the headers arrives
+  std::chrono::steady_clock::time_point first{};
   // Loop until empty line as per HTTP protocol
-  auto start_time = std::chrono::high_resolution_clock::now();
-  while (request.find("\n\n") == std::string::npos) {
-    // Verify appropriate conditions before attempting to service request
-    auto timediff = std::chrono::high_resolution_clock::now() - start_time;
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(timediff);
-    if (duration < std::chrono::duration<int>{3} && valid(fd)) {
-      // Determine if the client is readable with a delay of 10 ms
-      if (ready(fd, 0, 10000)) {
-        // Prepare a buffer for the incoming data
-        unsigned char buffer[BUFSIZE] = {};
-        // Read up to (BUFSIZE - 1) bytes from the file descriptor to ensure a
-        // null character at the end to prevent overflow
-        ssize_t data_read = read(fd, buffer, BUFSIZE - 1);
-        if (data_read > 0) {
-          // NULL the character following the last byte that was read
-          buffer[data_read] = 0;
-          // Copy the buffer into a std::string
-          std::string req{reinterpret_cast<const char*>(buffer)};
-          // Ensure only newline characters are in the reponse, not CRLF
-          // (canonicalizes requests so that only LF may be used)
-          for (auto loc = req.find("\r\n"); loc != std::string::npos;
-              loc = req.find("\r\n", ++loc))
-            req.replace(loc, 2, "\n");
-          // Append req to the request headers
-          request += req;
-        }
-        else if (data_read == 0) {
-          // The client has disconnected if marked as readable, but no data was
-          // received from it
-          request.clear();
-          break;
-        }
-      }
-    }
-    else {
+  while (request.complete() == false) {
+    // Wait for data until the deadline passes
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    // (records already decrypted by OpenSSL won't make the socket readable)
+    if (remaining <= 0 || (!Tls::pending(ssl) && !ready(fd,
+        static_cast<int>(remaining / 1000000),
+        static_cast<int>(remaining % 1000000))))
       // The client failed to write a complete set of request headers in the
-      // required time or its file descriptor became invalid
-      request.clear();
-      break;
-    }
+      // required time
+      return false;
+    // Read the incoming data directly into the request's buffer
+    size_t length = 0;
+    char*  buffer = request.space(length);
+    ssize_t data_read = Tls::read(ssl, fd, buffer, length);
+    if (data_read < 0 && errno == EINTR)
+      continue;
+    if (data_read <= 0)
+      // The client has disconnected if marked as readable, but no data was
+      // received from it
+      return false;
+    if (first == std::chrono::steady_clock::time_point{})
+      first = std::chrono::steady_clock::now();
+    request.received(static_cast<size_t>(data_read));
+    if (request.overflow())
+      return false;
   }
-  return Utility::explode(Utility::trim(request), "\n");
-}
-
-/**
- * @brief Ready
- *
- * Determines if a specific file descriptor is ready for reading
- *
- * @param  fd  The file descriptor to test
- *
- * @return     true if ready, otherwise false
- */
-bool ready(int fd, int sec, int usec) {
-  // Setup storage to determine if fd is readable
-  fd_set rfds;
-  FD_ZERO(&rfds);
-  // Ensure a valid clifd
-  if (valid(fd))
-    FD_SET(fd, &rfds);
-  // Declare an immediate timeout
-  struct timeval timeout{sec, usec};
-  // Use select to determine status
-  select(fd + 1, &rfds, NULL, NULL, &timeout);
-  return FD_ISSET(fd, &rfds);
-}
-
-/**
- * Safely copies the contents of the given input file descriptor to the given
- * output file descriptor
- *
- * The provided input file descriptor is accessed read-only for writing to the
- * provided output file descriptor using `sendfile64` in a loop until the
- * requested data length has been written (except in the case of an error)
- *
- * This function guarantees a supported size of 8EiB minus 1 byte as per the
- * standard implementation for `int64_t` (using multiple calls to `sendfile64`)
- *
- * @param  in_fd        The file descriptor to which the data will be written
- * @param  out_fd       The data that should be written
- * @param  data_length  The amount of data to write (input size)
- *
- * @return              true if successful, otherwise false
- */
-bool safe_sendfile(int in_fd, int out_fd, int64_t data_length) {
-  int64_t data_sent    = 0;
-  ssize_t return_val   = 0;
-  // Loop while there is data remaining and sendfile(...) succeeds
-  while (return_val >= 0 && data_sent < data_length)
-    // Attempt to copy a chunk of data and record the amount written
-    return_val = sendfile64(out_fd, in_fd, &data_sent, data_length - data_sent);
-  return (data_sent == data_length);
-}
-
-/**
- * Safely writes the given data to a file descriptor
- *
- * The provided data is accessed read-only for writing to the provided file
- * descriptor using networking best practices such as looping until all data is
- * written (except in the case of an error) and using `unsigned char` to
- * correctly represent binary data
- *
- * This function guarantees a supported size of 64KiB minus 1 byte as per the
- * standard for `size_t`, but probably supports a greater size depending on your
- * operating system's implementation
- *
- * @param  fd    The file descriptor to which the data will be written
- * @param  data  The data that should be written
- *
- * @return       true if successful, otherwise false
- */
-bool safe_write(int fd, const std::string& data) {
-  const unsigned char* data_buf = reinterpret_cast<const unsigned char*>(
-                                  data.data());
-   size_t  data_length = data.length();
-   size_t  data_sent   = 0;
-  ssize_t  return_val  = 0;
-  // Loop while there is data remaining and write(...) succeeds
-  while (return_val >= 0 && data_sent < data_length) {
-    // Attempt to write a chunk of data and record the amount written
-    return_val = write(fd, data_buf + data_sent, data_length - data_sent);
-    if (return_val >= 0)
-      // Increase the data_sent count by data_written on this iteration
-      data_sent += static_cast<size_t>(return_val);
-  }
-  return (data_sent == data_length);
-}
-
-/**
- * Percent-decodes a given string using the format described in RFC 3986 § 2.1
- *
- * This method attempts to find and replace all patterns matching a percent
- * character followed by two hexadecimal characters (ranging from '0' to '9' and
- * 'A' to 'F') with an ASCII character represented by the hexadecimal value
- *
- * @param[out]  url    An input that might contain one or more percent-encoded
- *                     characters representing an ASCII value
- * @param       extra  Whether or not plus characters ('+') should be converted
- *                     to space characters (' ') before standard decoding occurs
- *
- * @return             The percent-decoded result containing its respective
- *                     ASCII substitutions for percent-encoded characters
- */
-std::string& urldecode(std::string& url, bool extra) {
-  // Optionally replace plus characters ('+') with a space character (' ')
-  // before decoding according to the standard
-  if (extra) std::regex_replace(url, std::regex{"+"}, " ");
-  // Define a pattern that matches any percent character followed by two
-  // hexadecimal characters (as per RFC 3986 § 2.1)
-  const std::regex  pattern{"\x25([0-9A-F]{2})", std::regex_constants::icase};
-  // Create storage to store each pattern match
-  std::smatch match{};
-  // Continue to search until no further matches occur
-  while(std::regex_search(url, match, pattern))
-    { // Fetch a pointer to the hexadecimal string
-    const char* hex = match[1].str().c_str();
-    // Convert the hexadecimal string to an ASCII character
-    char dec = static_cast<char>(strtol(hex, nullptr, 16));
-    // Perform a substitution of the original match with the decoded character
-    // in the original URL
-    url.replace(match.position(0), match.length(0), 1, dec); }
-  // Return a reference to the original parameter
-  return url;
-}
-
-/**
- * Determines if a file descriptor is considered valid for read, write, or other
- * input/output operations
- *
- * A file descriptor is considered invalid if a call requesting its flags fails
- * with the return value of `-1` or `errno` is set to `EBADF` (the provided
- * argument is not an open file descriptor). If neither case is satisfied, the
- * file descriptor is considered valid
- *
- * @param  fd  File descriptor that should be verified
- *
- * @return     `true` if the file descriptor is valid, `false` otherwise
- */
-inline bool valid(int fd) {
-  return (fcntl(fd, F_GETFD) != -1 || errno != EBADF);
+  // Requests that were received along with the previous one took no time to
+  // read
+  trace.mark(Metrics::HeaderRead, (first ==
+    std::chrono::steady_clock::time_point{} ?
+    std::chrono::steady_clock::duration{0} :
+    std::chrono::steady_clock::now() - first));
+  return true;
 }
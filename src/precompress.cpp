@@ -0,0 +1,513 @@
+/**
+ * @file  precompress.cpp
+ * @brief Sidecar Precompressor
+ *
+ * Companion executable that walks an htdocs tree and writes gzip (FILE.gz) and
+ * brotli (FILE.br) sidecars for compressible files using every available CPU,
+ * so that `slwhttp --precompressed` can serve them without compressing
+ * anything on the request path
+ *
+ * Sidecars are given the modification time of their source file, and any
+ * sidecar that is at least as new as its source is left alone, so running the
+ * tool again after a deploy only compresses the files that changed
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <algorithm>      // for max
+#include <atomic>         // for atomic
+#include <cerrno>         // for errno, EINTR
+#include <climits>        // for LLONG_MAX
+#include <cstdio>         // for rename, remove
+#include <cstdlib>        // for exit, EXIT_FAILURE, mkstemp, etc
+#include <cstring>        // for strerror
+#include <dirent.h>       // for opendir, readdir, closedir, DT_DIR, etc
+#include <fcntl.h>        // for open, O_RDONLY, O_CLOEXEC
+#include <iostream>       // for operator<<, basic_ostream, endl, etc
+#include <mutex>          // for mutex, unique_lock
+#include <stdexcept>      // for exception, runtime_error
+#include <string>         // for string, allocator, operator+, etc
+#include <sys/stat.h>     // for stat, lstat, fchmod, S_ISREG, etc
+#include <sys/time.h>     // for timespec
+#include <thread>         // for thread
+#include <unistd.h>       // for close, read, write, etc
+#include <vector>         // for vector
+#include <zlib.h>         // for deflateInit2, deflate, deflateEnd, etc
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h> // for BrotliEncoderCompress, etc
+#endif
+
+// Define storage for global configuration state
+bool      _brotli = true;
+bool       _force = false;
+bool        _gzip = true;
+int         _jobs = 0;
+size_t  _min_size = 256;
+std::mutex _mutex = {};
+bool     _verbose = false;
+
+// The extensions of files that are worth compressing
+static const char* const _extensions[] = {
+  ".css", ".csv", ".htm", ".html", ".ico", ".js", ".json", ".map", ".md",
+  ".mjs", ".svg", ".ttf", ".txt", ".wasm", ".xml"
+};
+
+/**
+ * @struct Totals
+ * @brief  Counts of the work done across all threads
+ */
+struct Totals {
+  std::atomic<size_t>   failed{0};
+  std::atomic<size_t>  skipped{0};
+  std::atomic<size_t>  written{0};
+};
+
+// Function prototypes
+std::string compress_brotli(const std::string& data);
+std::string compress_gzip(const std::string& data);
+bool        compressible(const std::string& name);
+void        find_files(const std::string& dir, std::vector<std::string>& out);
+size_t      parse_size(const std::string& str);
+void        precompress(const std::string& path, Totals& totals);
+void        print_help(bool should_exit = true);
+std::string read_file(const std::string& path, struct stat& info);
+void        report(const std::string& message, bool error = false);
+bool        write_sidecar(const std::string& path, const std::string& data,
+              const struct stat& info);
+
+int main(int argc, const char* argv[]) {
+  // Gather a vector of all arguments from argv[]
+  std::vector<std::string> arguments{};
+  for (int i = 1; i < argc; ++i)
+    arguments.push_back(argv[i]);
+
+  // Iterate over the options until no more arguments exist
+  std::vector<std::string> roots{};
+  for (auto it = arguments.begin(); it != arguments.end(); ++it) {
+    const std::string& option = *it;
+    if (option == "--force")
+      _force = true;
+    else if (option == "--help")
+      print_help();
+    else if (option == "--jobs") {
+      if (it + 1 != arguments.end()) {
+        try {
+          _jobs = std::stoi(*(++it));
+          if (_jobs < 0)
+            throw std::out_of_range{"negative job count"};
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided job count is not a valid number"
+            << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no job count was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--min-size") {
+      if (it + 1 != arguments.end()) {
+        try {
+          _min_size = parse_size(*(++it));
+        } catch (const std::exception& e) {
+          std::cerr << "Error: the provided size is not valid" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      else {
+        std::cerr << "Error: no size was provided" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (option == "--no-brotli")
+      _brotli = false;
+    else if (option == "--no-gzip")
+      _gzip = false;
+    else if (option == "--verbose")
+      _verbose = true;
+    else
+      roots.push_back(option);
+  }
+
+  // Check that at least one directory was specified
+  if (roots.size() == 0) {
+    std::cerr << "Error: htdocs directory not specified" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+#ifndef HAVE_BROTLI
+  _brotli = false;
+#endif
+
+  // Collect the compressible files below each directory
+  std::vector<std::string> files{};
+  for (const std::string& root : roots) {
+    struct stat info;
+    if (stat(root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+      std::cerr << "Error: could not traverse \"" << root << "\"" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    find_files(root, files);
+  }
+
+  // Compress the files using a pool of threads sharing one work index
+  if (_jobs == 0)
+    _jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  Totals totals{};
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> threads{};
+  for (int i = 0; i < _jobs; ++i)
+    threads.emplace_back([&files, &next, &totals]() {
+      for (size_t j = next++; j < files.size(); j = next++)
+        precompress(files[j], totals);
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+
+  report(std::to_string(files.size()) + " files, " +
+    std::to_string(totals.written) + " sidecars written, " +
+    std::to_string(totals.skipped) + " up to date, " +
+    std::to_string(totals.failed)  + " failed");
+  return (totals.failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/**
+ * @brief Compress (Brotli)
+ *
+ * Compresses a buffer using brotli at its highest quality
+ *
+ * @param  data  The data to compress
+ *
+ * @return       std::string compressed data
+ */
+std::string compress_brotli(const std::string& data) {
+#ifdef HAVE_BROTLI
+  size_t length = BrotliEncoderMaxCompressedSize(data.length());
+  if (length == 0)
+    throw std::runtime_error{"input is too large for brotli"};
+  std::string output(length, '\0');
+  if (BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW,
+      BROTLI_MODE_GENERIC, data.length(),
+      reinterpret_cast<const uint8_t*>(data.data()), &length,
+      reinterpret_cast<uint8_t*>(&output[0])) == BROTLI_FALSE)
+    throw std::runtime_error{"brotli compression failed"};
+  output.resize(length);
+  return output;
+#else
+  (void)data;
+  throw std::runtime_error{"built without brotli support"};
+#endif
+}
+
+/**
+ * @brief Compress (Gzip)
+ *
+ * Compresses a buffer into the gzip format at zlib's highest level
+ *
+ * @param  data  The data to compress
+ *
+ * @return       std::string compressed data
+ */
+std::string compress_gzip(const std::string& data) {
+  z_stream stream{};
+  // A window size of 15 + 16 selects the gzip wrapper instead of zlib's own
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9,
+      Z_DEFAULT_STRATEGY) != Z_OK)
+    throw std::runtime_error{"failed to initialize zlib"};
+  std::string output(deflateBound(&stream, data.length()), '\0');
+  stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in  = static_cast<uInt>(data.length());
+  stream.next_out  = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = static_cast<uInt>(output.length());
+  int result = deflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END)
+    throw std::runtime_error{"gzip compression failed"};
+  return output;
+}
+
+/**
+ * @brief Compressible
+ *
+ * Determines if a file is worth compressing based on its extension
+ *
+ * @param  name  The name of the file
+ *
+ * @return       true if the file should be compressed, otherwise false
+ */
+bool compressible(const std::string& name) {
+  size_t dot = name.find_last_of('.');
+  if (dot == std::string::npos)
+    return false;
+  std::string extension{name, dot};
+  for (char& c : extension)
+    c = static_cast<char>(tolower(c));
+  for (const char* candidate : _extensions)
+    if (extension == candidate)
+      return true;
+  return false;
+}
+
+/**
+ * @brief Find Files
+ *
+ * Recursively collects the compressible regular files below a directory
+ * without following symbolic links (which may point outside of the tree)
+ *
+ * @param[in]   dir  The directory to search
+ * @param[out]  out  The list of files to append to
+ */
+void find_files(const std::string& dir, std::vector<std::string>& out) {
+  DIR* handle = opendir(dir.c_str());
+  if (handle == nullptr) {
+    report("could not open \"" + dir + "\": " + strerror(errno), true);
+    return;
+  }
+  std::vector<std::string> subdirs{};
+  while (struct dirent* item = readdir(handle)) {
+    std::string name{item->d_name};
+    if (name == "." || name == "..")
+      continue;
+    std::string path{dir + "/" + name};
+    unsigned char type = item->d_type;
+    if (type == DT_UNKNOWN) {
+      struct stat info;
+      if (lstat(path.c_str(), &info) != 0)
+        continue;
+      type = (S_ISDIR(info.st_mode) ? DT_DIR :
+        (S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN));
+    }
+    if (type == DT_DIR)
+      subdirs.push_back(path);
+    else if (type == DT_REG && compressible(name))
+      out.push_back(path);
+  }
+  closedir(handle);
+  for (const std::string& subdir : subdirs)
+    find_files(subdir, out);
+}
+
+/**
+ * @brief Parse Size
+ *
+ * Parses a number of bytes with an optional binary suffix ('k', 'm' or 'g')
+ *
+ * @param  str  The input string (such as "16k")
+ *
+ * @return      The number of bytes
+ */
+size_t parse_size(const std::string& str) {
+  size_t end  = 0;
+  long long size = std::stoll(str, &end);
+  std::string suffix{str.substr(end)};
+  for (char& c : suffix)
+    c = static_cast<char>(tolower(c));
+  int shift = 0;
+  if (suffix == "k")
+    shift = 10;
+  else if (suffix == "m")
+    shift = 20;
+  else if (suffix == "g")
+    shift = 30;
+  else if (suffix.length() > 0)
+    throw std::invalid_argument{"unknown size suffix \"" + suffix + "\""};
+  if (size < 0 || size > (LLONG_MAX >> shift))
+    throw std::out_of_range{"size out of range"};
+  return static_cast<size_t>(size) << shift;
+}
+
+/**
+ * @brief Precompress
+ *
+ * Writes each enabled sidecar of a file unless it is already up to date
+ *
+ * A sidecar that wouldn't be smaller than its source isn't written, since
+ * serving it would only cost the client a decompression
+ *
+ * @param  path    The path of the source file
+ * @param  totals  The counts to update
+ */
+void precompress(const std::string& path, Totals& totals) {
+  static const struct {
+    bool*       enabled;
+    const char* extension;
+    std::string (*compress)(const std::string&);
+  } sidecars[] = {
+    {&_gzip,   ".gz", compress_gzip},
+    {&_brotli, ".br", compress_brotli}
+  };
+  try {
+    struct stat source;
+    if (stat(path.c_str(), &source) != 0)
+      throw std::runtime_error{strerror(errno)};
+    if (static_cast<size_t>(source.st_size) < _min_size)
+      return;
+    std::string data{};
+    for (const auto& sidecar : sidecars) {
+      if (*sidecar.enabled == false)
+        continue;
+      // Skip sidecars that are at least as new as their source
+      std::string target{path + sidecar.extension};
+      struct stat existing;
+      if (_force == false && stat(target.c_str(), &existing) == 0 &&
+          (existing.st_mtim.tv_sec > source.st_mtim.tv_sec ||
+           (existing.st_mtim.tv_sec  == source.st_mtim.tv_sec &&
+            existing.st_mtim.tv_nsec >= source.st_mtim.tv_nsec))) {
+        ++totals.skipped;
+        continue;
+      }
+      if (data.length() == 0)
+        data = read_file(path, source);
+      std::string compressed = sidecar.compress(data);
+      if (compressed.length() >= data.length())
+        continue;
+      if (write_sidecar(target, compressed, source) == false)
+        throw std::runtime_error{"could not write \"" + target + "\""};
+      ++totals.written;
+      if (_verbose == true)
+        report(target + " (" + std::to_string(data.length()) + " -> " +
+          std::to_string(compressed.length()) + " bytes)");
+    }
+  } catch (const std::exception& e) {
+    ++totals.failed;
+    report(path + ": " + e.what(), true);
+  }
+}
+
+/**
+ * @brief Print Help
+ *
+ * Prints help information and optionally calls exit(...)
+ *
+ * @param  should_exit  Bool saying whether or not the program should exit upon
+ *                      completion of the function
+ */
+void print_help(bool should_exit) {
+  std::cerr << "Usage: " << PACKAGE_NAME << "-precompress [OPTIONS] PATH..."
+            << std::endl
+            << "Writes gzip and brotli sidecars (FILE.gz, FILE.br) for the"
+            << std::endl
+            << "compressible files below each PATH." << std::endl
+            << std::endl
+            << "Command line options:" << std::endl
+            << "  --force    rewrite sidecars that are already up to date"
+            << std::endl
+            << "  --help     display this help and exit" << std::endl
+            << "  --jobs     compress N files at a time (default: one per CPU)"
+            << std::endl
+            << "  --min-size skip files smaller than SIZE (default: 256)"
+            << std::endl
+            << "  --no-brotli" << std::endl
+            << "             don't write brotli sidecars" << std::endl
+            << "  --no-gzip  don't write gzip sidecars" << std::endl
+            << "  --verbose  print each sidecar as it is written" << std::endl
+            << std::endl
+            << "Examples:" << std::endl
+            << "  " << PACKAGE_NAME << "-precompress /var/www" << std::endl
+            << "  " << PACKAGE_NAME << "-precompress --jobs 4 --no-brotli "
+               "/var/www" << std::endl
+            << std::endl
+            << PACKAGE_NAME << "-" << PACKAGE_VERSION << " online help: <"
+            << PACKAGE_URL << ">"
+            << std::endl;
+  if (should_exit == true)
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Read File
+ *
+ * Reads an entire file into memory
+ *
+ * @param[in]   path  The path of the file
+ * @param[out]  info  The status of the file as it was read
+ *
+ * @return            std::string file contents
+ */
+std::string read_file(const std::string& path, struct stat& info) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error{strerror(errno)};
+  std::string data{};
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+    data.resize(static_cast<size_t>(info.st_size));
+    size_t data_read = 0;
+    while (data_read < data.length()) {
+      ssize_t return_val = read(fd, &data[data_read],
+        data.length() - data_read);
+      if (return_val < 0 && errno == EINTR)
+        continue;
+      if (return_val <= 0)
+        break;
+      data_read += static_cast<size_t>(return_val);
+    }
+    data.resize(data_read);
+  }
+  close(fd);
+  return data;
+}
+
+/**
+ * @brief Report
+ *
+ * Prints a message to the standard error stream without interleaving it with
+ * messages from other threads
+ *
+ * @param  message  The message to print
+ * @param  error    Whether or not the message describes an error
+ */
+void report(const std::string& message, bool error) {
+  std::unique_lock<std::mutex> lock{_mutex};
+  std::cerr << (error == true ? "Error: " : "") << message << std::endl;
+}
+
+/**
+ * @brief Write Sidecar
+ *
+ * Atomically replaces a sidecar by writing it to a temporary file in the same
+ * directory and renaming it into place, so that the server never opens a
+ * partially written sidecar
+ *
+ * @param  path  The path of the sidecar
+ * @param  data  The contents of the sidecar
+ * @param  info  The status of the source file, whose permissions and
+ *               modification time are copied to the sidecar
+ *
+ * @return       true if the sidecar was written, otherwise false
+ */
+bool write_sidecar(const std::string& path, const std::string& data,
+    const struct stat& info) {
+  size_t slash = path.find_last_of('/');
+  std::string temp{path.substr(0, slash + 1) + "." +
+    path.substr(slash + 1) + ".XXXXXX"};
+  int fd = mkstemp(&temp[0]);
+  if (fd < 0)
+    return false;
+  size_t data_written = 0;
+  while (data_written < data.length()) {
+    ssize_t return_val = write(fd, data.data() + data_written,
+      data.length() - data_written);
+    if (return_val < 0 && errno == EINTR)
+      continue;
+    if (return_val <= 0)
+      break;
+    data_written += static_cast<size_t>(return_val);
+  }
+  // Match the source so that the sidecar is exactly as new as its source
+  struct timespec times[2] = {info.st_atim, info.st_mtim};
+  bool success = (data_written == data.length() &&
+    fchmod(fd, info.st_mode & 07777) == 0 && futimens(fd, times) == 0);
+  if (close(fd) != 0)
+    success = false;
+  if (success == true && rename(temp.c_str(), path.c_str()) == 0)
+    return true;
+  remove(temp.c_str());
+  return false;
+}
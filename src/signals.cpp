@@ -0,0 +1,233 @@
+/**
+ * @file  signals.cpp
+ * @brief Reloads & Upgrades
+ *
+ * Functions that reload the server on SIGHUP, and on SIGUSR2 start a new copy
+ * of the executable that takes over the listening sockets while this process
+ * finishes serving the clients it already has
+ *
+ * The listening sockets are passed to the new process by inheritance, naming
+ * them in its environment, so clients keep queueing on the same sockets for the
+ * whole upgrade and none are refused.  The old process only stops accepting
+ * (and starts draining) once the new process has parsed its options and become
+ * a daemon, and keeps serving if it fails to start
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <cerrno>         // for errno, EINTR
+#include <csignal>        // for sigwait, sigprocmask, SIGHUP, SIGUSR2, etc
+#include <cstdlib>        // for getenv, unsetenv
+#include <cstring>        // for strncmp
+#include <fcntl.h>        // for fcntl, F_SETFD, FD_CLOEXEC
+#include <netinet/in.h>   // for sockaddr_in, ntohs
+#include <stdexcept>      // for exception
+#include <string>         // for string, stoi, to_string
+#include <sys/resource.h> // for getrlimit, RLIMIT_NOFILE
+#include <sys/socket.h>   // for getsockopt, getsockname, SO_ACCEPTCONN
+#include <sys/syscall.h>  // for __NR_close_range
+#include <sys/wait.h>     // for waitpid, WIFEXITED, WEXITSTATUS
+#include <unistd.h>       // for access, chdir, execve, fork, close, etc
+#include <vector>         // for vector
+#ifdef __NR_close_range
+#include <linux/close_range.h> // for CLOSE_RANGE_CLOEXEC
+#endif
+
+// User-level header includes
+#include "include/AccessLog.hpp"
+#include "include/FileCache.hpp"
+#include "include/Metrics.hpp"
+#include "include/StaticTree.hpp"
+#include "include/slwhttp.hpp"
+
+extern char** environ;
+
+/**
+ * @brief Executable
+ *
+ * Determines the path of the executable as it was started (searching `PATH`
+ * again, so that an upgrade runs whatever is installed there now)
+ *
+ * @return  The path of the executable
+ */
+static std::string executable() {
+  const std::string& name = _argv[0];
+  if (name.find('/') != std::string::npos)
+    return (name[0] == '/' ? name : _cwd + "/" + name);
+  const char* variable = getenv("PATH");
+  const std::string path{variable != nullptr ? variable : "/usr/bin:/bin"};
+  size_t position = 0;
+  while (position <= path.length()) {
+    size_t end = path.find(':', position);
+    if (end == std::string::npos)
+      end = path.length();
+    const std::string candidate = (end > position ?
+      path.substr(position, end - position) : ".") + "/" + name;
+    if (access(candidate.c_str(), X_OK) == 0)
+      return (candidate[0] == '/' ? candidate : _cwd + "/" + candidate);
+    position = end + 1;
+  }
+  return name;
+}
+
+/**
+ * @brief Handle Signals
+ *
+ * Waits for (and acts upon) the given signals, which must be blocked in every
+ * thread of the process
+ *
+ * @param  signals  The signals to wait for
+ */
+void handle_signals(sigset_t signals) {
+  while (true) {
+    int signal = 0;
+    if (sigwait(&signals, &signal) != 0)
+      continue;
+    if (signal == SIGHUP)
+      reload();
+    else if (signal == SIGUSR2)
+      upgrade();
+  }
+}
+
+/**
+ * @brief Inherited Sockets
+ *
+ * Takes over the listening sockets named in the given environment variable by
+ * the process this one replaced, ignoring any that aren't listening on the
+ * given port (which are closed if they are listening elsewhere)
+ *
+ * @param  variable  The name of the environment variable
+ * @param  port      The port the sockets should be listening on
+ *
+ * @return           The inherited listening sockets
+ */
+std::vector<int> inherited_sockets(const char* variable, int port) {
+  std::vector<int> sockfds{};
+  const char* value = getenv(variable);
+  if (value == nullptr)
+    return sockfds;
+  // Keep the variable from reaching any process started by this one
+  const std::string list{value};
+  unsetenv(variable);
+  size_t position = 0;
+  while (position < list.length()) {
+    size_t end = list.find(',', position);
+    if (end == std::string::npos)
+      end = list.length();
+    int sockfd = -1;
+    try {
+      sockfd = std::stoi(list.substr(position, end - position));
+    } catch (const std::exception&) {}
+    position = end + 1;
+    int listening = 0;
+    socklen_t size = sizeof(listening);
+    struct sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (sockfd < 0 || getsockopt(sockfd, SOL_SOCKET, SO_ACCEPTCONN,
+        &listening, &size) != 0 || listening == 0 ||
+        getsockname(sockfd, reinterpret_cast<struct sockaddr*>(&address),
+          &length) != 0)
+      continue;
+    if (address.sin_family == AF_INET && ntohs(address.sin_port) == port) {
+      debug("inherited listening socket {} on port {}", sockfd, port);
+      sockfds.push_back(sockfd);
+    }
+    else
+      close(sockfd);
+  }
+  return sockfds;
+}
+
+/**
+ * @brief Reload
+ *
+ * Reopens the access log, marks every cached file to be checked again and
+ * rescans the static tree, all without interrupting any client
+ */
+void reload() {
+  debug("reloading");
+  if (AccessLog::enabled())
+    AccessLog::reopen();
+  FileCache::invalidate();
+  StaticTree::reload();
+}
+
+/**
+ * @brief Upgrade
+ *
+ * Starts a new copy of the executable (with the same arguments and working
+ * directory) that inherits the listening sockets, then begins draining this
+ * process once the new one has become a daemon
+ */
+void upgrade() {
+  if (_draining.load() == true)
+    return;
+  // Name the sockets to hand over in the new process's environment
+  std::vector<int> sockfds{_sockfds};
+  std::string sockets{};
+  for (int sockfd : sockfds)
+    sockets += (sockets.empty() ? "" : ",") + std::to_string(sockfd);
+  std::vector<std::string> variables{std::string{SOCKETSENV} + "=" + sockets};
+  if (Metrics::listener() >= 0) {
+    sockfds.push_back(Metrics::listener());
+    variables.push_back(std::string{METRICSENV} + "=" +
+      std::to_string(Metrics::listener()));
+  }
+  for (char** variable = environ; *variable != nullptr; ++variable)
+    if (strncmp(*variable, SOCKETSENV "=", sizeof(SOCKETSENV)) != 0 &&
+        strncmp(*variable, METRICSENV "=", sizeof(METRICSENV)) != 0)
+      variables.push_back(*variable);
+  // Prepare everything the child needs, since it mustn't allocate memory
+  std::vector<std::string> arguments{_argv};
+  std::vector<char*> argv{};
+  for (std::string& argument : arguments)
+    argv.push_back(&argument[0]);
+  argv.push_back(nullptr);
+  std::vector<char*> envp{};
+  for (std::string& variable : variables)
+    envp.push_back(&variable[0]);
+  envp.push_back(nullptr);
+  const std::string path = executable();
+  struct rlimit limit{};
+  int descriptors = (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+    limit.rlim_cur < 65536 ? static_cast<int>(limit.rlim_cur) : 65536);
+  debug("upgrading to {}", path);
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Let the new process handle its own signals and see only the sockets
+    // being handed to it
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+#if defined(__NR_close_range) && defined(CLOSE_RANGE_CLOEXEC)
+    if (syscall(__NR_close_range, 3, ~0U, CLOSE_RANGE_CLOEXEC) != 0)
+#endif
+      for (int fd = 3; fd < descriptors; ++fd)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    for (int sockfd : sockfds)
+      fcntl(sockfd, F_SETFD, 0);
+    if (chdir(_cwd.c_str()) == 0)
+      execve(path.c_str(), argv.data(), envp.data());
+    _exit(127);
+  }
+  if (pid < 0) {
+    debug_error("failed to start a new process");
+    return;
+  }
+  // The new process exits successfully once it has become a daemon
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+  if (WIFEXITED(status) == false || WEXITSTATUS(status) != 0) {
+    debug("new process failed to start (status {}), still serving", status);
+    return;
+  }
+  debug("listening sockets handed to a new process, draining clients");
+  _draining.store(true);
+}
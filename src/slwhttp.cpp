@@ -0,0 +1,59 @@
+/**
+ * @file  slwhttp.cpp
+ * @brief Global Configuration State
+ *
+ * Storage for the global configuration state declared in slwhttp.hpp, kept
+ * apart from main(...) so that benchmarks can link the rest of the server
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <atomic>         // for atomic
+#include <string>         // for string
+#include <vector>         // for vector
+
+// User-level header includes
+#include "include/AccessLog.hpp"
+#include "include/BufferPool.hpp"
+#include "include/Worker.hpp"
+#include "include/slwhttp.hpp"
+
+// Define storage for global configuration state
+std::string                _access_log = "";
+AccessLog::Format   _access_log_format = AccessLog::Format::Common;
+std::vector<std::string>         _argv{};
+int                           _backlog = 256;
+size_t                      _bandwidth = 0;
+BufferPool                    _buffers{MAXHEADERS, POOLBUFS};
+std::string                       _cwd = "";
+bool                            _debug = false;
+std::atomic<bool>            _draining{false};
+int                    _header_timeout = 3;
+std::string                    _htdocs = "";
+size_t                  _inline_budget = 64 << 20;
+size_t                     _inline_max = 0;
+Worker::Backend            _io_backend = Worker::Backend::Epoll;
+int                         _keepalive = 5;
+int                   _max_connections = 0;
+int                      _max_requests = 0;
+int                      _metrics_port = 0;
+bool                            _mlock = false;
+bool                              _pin = false;
+int                              _port = 80;
+size_t                     _rate_limit = 0;
+bool                        _reuseport = false;
+int                            _sockfd = -1;
+std::vector<int>              _sockfds{};
+bool                      _static_tree = false;
+std::string           _tls_certificate = "";
+std::string                   _tls_key = "";
+int                      _trace_sample = 0;
+std::string                 _warm_list = "";
+std::vector<std::string> _warm_targets{};
+int                           _workers = 0;
@@ -0,0 +1,126 @@
+/**
+ * @file  urldecode.cpp
+ * @brief Percent-Decoding
+ *
+ * Implementation of urldecode
+ *
+ * The decoder makes a single pass over its input, decoding in place: runs of
+ * literal characters are found using `memchr` (or an SSE2 scan when plus
+ * characters must also be found) and moved down over the space freed by any
+ * escapes before them, and each escape is decoded using a lookup table
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "include/urldecode.hpp"
+
+/**
+ * @brief Hex Table
+ *
+ * Maps each byte to the value of the hexadecimal digit it represents, or to -1
+ * if it isn't a hexadecimal digit
+ */
+static const signed char hex[256] = {
+#define X -1
+#define R16 X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X
+  R16, R16, R16,
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+  X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+  R16,
+  X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+  R16, R16, R16, R16, R16, R16, R16, R16, R16
+#undef R16
+#undef X
+};
+
+/**
+ * @brief Find Special
+ *
+ * Finds the next character that must be decoded
+ *
+ * @param  begin  The first character to search
+ * @param  end    The end of the input
+ * @param  extra  Whether or not plus characters ('+') must also be found
+ *
+ * @return        A pointer to the next percent (or plus) character, or end if
+ *                none remain
+ */
+static const char* find_special(const char* begin, const char* end,
+    bool extra) {
+  if (extra == false) {
+    const void* found = memchr(begin, '%', static_cast<size_t>(end - begin));
+    return (found != nullptr ? static_cast<const char*>(found) : end);
+  }
+#ifdef __SSE2__
+  const __m128i percent = _mm_set1_epi8('%');
+  const __m128i plus    = _mm_set1_epi8('+');
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int     mask  = _mm_movemask_epi8(_mm_or_si128(
+      _mm_cmpeq_epi8(chunk, percent), _mm_cmpeq_epi8(chunk, plus)));
+    if (mask != 0)
+      return begin + __builtin_ctz(static_cast<unsigned>(mask));
+  }
+#endif
+  while (begin < end && *begin != '%' && *begin != '+')
+    ++begin;
+  return begin;
+}
+
+/**
+ * Percent-decodes a given string using the format described in RFC 3986 § 2.1
+ *
+ * This method replaces each percent character followed by two hexadecimal
+ * characters (ranging from '0' to '9' and 'A' to 'F', in either case) with the
+ * character represented by the hexadecimal value.  Percent characters that
+ * aren't followed by two hexadecimal characters are left as-is, and decoded
+ * characters are never decoded again (so "%2541" becomes "%41")
+ *
+ * @param[out]  url    An input that might contain one or more percent-encoded
+ *                     characters representing an ASCII value
+ * @param       extra  Whether or not plus characters ('+') should be converted
+ *                     to space characters (' ') as in form-encoded data
+ * @param       start  The offset at which decoding begins (the characters
+ *                     before it are left as-is)
+ *
+ * @return             The percent-decoded result containing its respective
+ *                     ASCII substitutions for percent-encoded characters
+ */
+std::string& urldecode(std::string& url, bool extra, size_t start) {
+  if (start >= url.length())
+    return url;
+  char*       out = &url[start];
+  const char* in  = out;
+  const char* end = url.data() + url.length();
+  while (true) {
+    // Move the run of literal characters before the next escape into place
+    const char* next = find_special(in, end, extra);
+    size_t      run  = static_cast<size_t>(next - in);
+    if (out != in)
+      memmove(out, in, run);
+    out += run;
+    in   = next;
+    if (in == end)
+      break;
+    const unsigned char* digits = reinterpret_cast<const unsigned char*>(in);
+    if (*in == '+') {
+      *out++ = ' ';
+      in    += 1;
+    }
+    else if (end - in >= 3 && hex[digits[1]] >= 0 && hex[digits[2]] >= 0) {
+      *out++ = static_cast<char>((hex[digits[1]] << 4) | hex[digits[2]]);
+      in    += 3;
+    }
+    else
+      *out++ = *in++;
+  }
+  url.resize(static_cast<size_t>(out - url.data()));
+  return url;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file  warm.cpp
+ * @brief Cache Warm-Up
+ *
+ * Functions that read the request targets a client is expected to ask for
+ * (from a list of paths or an access log) and load them into the file cache
+ * before the server starts accepting clients
+ *
+ * The list is read while the server still has full privileges (so that a
+ * protected access log can be used), but the files themselves are only opened
+ * once privileges have been dropped, exactly as they would be for a client.
+ * The cache of each NUMA node is warmed from a thread running on one of its
+ * CPUs
+ *
+ * This work is licensed under the Creative Commons Attribution-ShareAlike 4.0
+ * International License. To view a copy of this license, visit:
+ * http://creativecommons.org/licenses/by-sa/4.0/
+ *
+ * @author     Clay Freeman
+ * @date       October 14, 2026
+ */
+
+// System-level header includes
+#include <algorithm>      // for sort
+#include <atomic>         // for atomic
+#include <cstring>        // for memcpy
+#include <fstream>        // for ifstream
+#include <functional>     // for cref, ref
+#include <sched.h>        // for sched_setaffinity, CPU_SET, etc
+#include <stdexcept>      // for runtime_error
+#include <string>         // for string, getline
+#include <thread>         // for thread
+#include <unordered_map>  // for unordered_map
+#include <utility>        // for pair
+#include <vector>         // for vector
+
+// User-level header includes
+#include "include/FileCache.hpp"
+#include "include/Request.hpp"
+#include "include/slwhttp.hpp"
+
+// The number of bytes read from the end of a warm-up list (enough to cover the
+// recent history of an access log without reading all of it)
+#define WARMTAIL (16 << 20)
+
+/**
+ * @brief Warm Target
+ *
+ * Extracts the request target from a line of a warm-up list, which is either
+ * a bare path or a line of an access log in any of the supported formats
+ *
+ * @param  line  The line of the warm-up list
+ *
+ * @return       The request target, or an empty string if there isn't one
+ */
+static std::string warm_target(const std::string& line) {
+  size_t start = line.find_first_not_of(" \t");
+  size_t end   = std::string::npos;
+  if (start == std::string::npos || line[start] == '#')
+    return "";
+  if (line[start] == '/')
+    end = line.find_first_of(" \t\r", start);
+  else if (line.find("\"method\":\"GET\"") != std::string::npos &&
+      (start = line.find("\"path\":\"")) != std::string::npos) {
+    start += sizeof("\"path\":\"") - 1;
+    end    = line.find('"', start);
+  }
+  else if ((start = line.find("\"GET ")) != std::string::npos) {
+    start += sizeof("\"GET ") - 1;
+    end    = line.find_first_of(" \"", start);
+  }
+  else
+    return "";
+  std::string target = line.substr(start, (end == std::string::npos ?
+    std::string::npos : end - start));
+  target.erase(std::min(target.find('?'), target.length()));
+  // Skip targets that the access log had to escape
+  if (target.empty() || target[0] != '/' ||
+      target.find('\\') != std::string::npos)
+    return "";
+  return target;
+}
+
+/**
+ * @brief Read Warm List
+ *
+ * Reads the request targets from the end of a warm-up list, ordered from the
+ * most to the least frequently requested
+ *
+ * @param  list  The path of the warm-up list
+ *
+ * @return       The distinct request targets of the warm-up list
+ */
+std::vector<std::string> read_warm_list(const std::string& list) {
+  std::ifstream input{list};
+  if (!input)
+    throw std::runtime_error{"failed to open warm-up list \"" + list + "\""};
+  // Skip to the last (whole) line before the tail of the list
+  input.seekg(0, std::ios::end);
+  std::streamoff size = input.tellg();
+  std::string line{};
+  if (size > WARMTAIL) {
+    input.seekg(size - WARMTAIL);
+    std::getline(input, line);
+  }
+  else
+    input.seekg(0);
+  // Count how many times each target appears
+  std::unordered_map<std::string, size_t> counts{};
+  while (std::getline(input, line)) {
+    std::string target = warm_target(line);
+    if (target.length() > 0)
+      ++counts[target];
+  }
+  std::vector<std::pair<size_t, std::string>> ranked{};
+  for (auto& count : counts)
+    ranked.emplace_back(count.second, count.first);
+  std::sort(ranked.begin(), ranked.end(),
+    [](const std::pair<size_t, std::string>& a,
+       const std::pair<size_t, std::string>& b) {
+      return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+  std::vector<std::string> targets{};
+  for (auto& target : ranked)
+    targets.push_back(std::move(target.second));
+  return targets;
+}
+
+/**
+ * @brief Warm Node
+ *
+ * Loads the files named by the given request targets into the cache of the
+ * NUMA node of the given CPU, from a thread running on that CPU (so that the
+ * content is held in the memory of the node)
+ *
+ * @param  targets  The request targets, from most to least frequent
+ * @param  count    The number of targets to load
+ * @param  cpu      A CPU of the node, or -1 to use the calling thread's node
+ * @param  warmed   Counts the files that could be served
+ */
+static void warm_node(const std::vector<std::string>& targets, size_t count,
+    int cpu, std::atomic<size_t>& warmed) {
+  if (cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+      debug_error("failed to warm the cache from CPU {}", cpu);
+    FileCache::pin(cpu);
+  }
+  // Resolve each target exactly as a request for it would be
+  Request request{_buffers};
+  std::string path{};
+  for (size_t i = count; i-- > 0;) {
+    const std::string line = "GET " + targets[i] + " HTTP/1.1\r\n\r\n";
+    size_t length = 0;
+    char* buffer = request.space(length);
+    if (line.length() <= length) {
+      memcpy(buffer, line.data(), line.length());
+      if (request.received(line.length()) && request_path(request, path) &&
+          FileCache::warm(path))
+        ++warmed;
+    }
+    request.consume();
+  }
+}
+
+/**
+ * @brief Warm Caches
+ *
+ * Loads the files named by the given request targets into the cache of every
+ * NUMA node (up to its share of the capacity), loading the most frequently
+ * requested last so that they are the last to be evicted
+ *
+ * @param  targets  The request targets, from most to least frequent
+ */
+void warm_caches(const std::vector<std::string>& targets) {
+  std::vector<int> cpus = FileCache::getNodes();
+  // Nothing loaded would be kept if the cache is disabled
+  size_t count = std::min(targets.size(), (FileCache::getCapacity() == 0 ? 0 :
+    std::max<size_t>(1, FileCache::getCapacity() / cpus.size())));
+  std::atomic<size_t> warmed{0};
+  std::vector<std::thread> threads{};
+  for (int cpu : cpus)
+    threads.emplace_back(warm_node, std::cref(targets), count, cpu,
+      std::ref(warmed));
+  for (std::thread& thread : threads)
+    thread.join();
+  debug("warmed {} of {} files across {} caches", warmed.load(),
+    count * cpus.size(), cpus.size());
+}